@@ -0,0 +1,252 @@
+/*
+ *  Latency-driven admission control for shedding excess load
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_ADMISSION_HPP
+#define _RTIMERS_ADMISSION_HPP
+
+#if __cplusplus < 201100
+#  error "rtimers/admission requires C++11 support"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+#include "core.hpp"
+#include "registry.hpp"
+
+
+namespace rtimers {
+
+
+/** Lock-free counts of recent samples, in a ring of time slots
+ *
+ *  Each slot counts the samples added during a fixed period of time,
+ *  and how many of those exceeded a latency threshold.
+ *  Slots are recycled lazily by the first sample to arrive in a new period,
+ *  so a few samples racing with that may be lost.
+ */
+template <typename CLK, unsigned NSLOTS=8>
+class LatencyWindow
+{
+  public:
+    typedef typename CLK::Instant Instant;
+
+    struct Totals
+    {
+      unsigned long count;
+      unsigned long over;     //!< Samples which exceeded the threshold
+    };
+
+    LatencyWindow(double thresh, double width)
+      : threshold(thresh), slotWidth(width), origin(CLK::now()) {
+      for (unsigned s=0; s<NSLOTS; ++s) {
+        slots[s].epoch.store(-1);
+        slots[s].count.store(0);
+        slots[s].over.store(0);
+      }
+    }
+
+    //! Add a sample, returning the slot number in which it was counted
+    long add(double dt) {
+      const long ep = epoch();
+      Slot& slot = slots[ep % NSLOTS];
+
+      long prev = slot.epoch.load(std::memory_order_acquire);
+      if (prev != ep
+          && slot.epoch.compare_exchange_strong(prev, ep,
+                                                std::memory_order_acq_rel)) {
+        slot.count.store(0, std::memory_order_relaxed);
+        slot.over.store(0, std::memory_order_relaxed);
+      }
+
+      slot.count.fetch_add(1, std::memory_order_relaxed);
+      if (dt > threshold) slot.over.fetch_add(1, std::memory_order_relaxed);
+      return ep;
+    }
+
+    //! Sum the counts of a number of complete slots before a given one
+    Totals recent(long ep, unsigned nslots) const {
+      Totals tot = { 0, 0 };
+
+      nslots = std::min(nslots, NSLOTS - 1);
+      for (unsigned j=1; j<=nslots && long(j)<=ep; ++j) {
+        const Slot& slot = slots[(ep - j) % NSLOTS];
+        if (slot.epoch.load(std::memory_order_acquire) != ep - long(j)) continue;
+        tot.count += slot.count.load(std::memory_order_relaxed);
+        tot.over += slot.over.load(std::memory_order_relaxed);
+      }
+      return tot;
+    }
+
+    //! The number of the slot covering the current time
+    long epoch() const {
+      return long(CLK::interval(origin, CLK::now()) / slotWidth);
+    }
+
+  protected:
+    struct alignas(64) Slot
+    {
+      std::atomic<long> epoch;
+      std::atomic<unsigned long> count;
+      std::atomic<unsigned long> over;
+    };
+
+    const double threshold;
+    const double slotWidth;
+    const Instant origin;
+    Slot slots[NSLOTS];
+};
+
+
+/** Load-shedding controller driven by the latency of a registered timer
+ *
+ *  This observes all samples added to a RegistryEntry (even while
+ *  its statistics are disabled), and estimates,
+ *  over a sliding window of one control interval, whether the chosen
+ *  percentile (e.g. p99) of latency exceeds a service-level objective.
+ *  In the manner of CoDel, shedding starts only once the objective has
+ *  been exceeded for a whole interval, after which the fraction of
+ *  requests rejected grows with the square root of the number of
+ *  consecutive intervals spent above the objective, and decays
+ *  gradually once latency has recovered.
+ *
+ *  The controller state is updated once per quarter interval,
+ *  by whichever thread first adds a sample in a new time slot,
+ *  so shouldAdmit() costs only an atomic load and (while shedding)
+ *  a thread-local random number.
+ *  \code
+ *  typedef AdmissionController<cxx11::HiResClock> Admission;
+ *  static Admission admission(Registry::global().lookup("db.query"), 20e-3);
+ *  if (!admission.shouldAdmit()) return rejectBusy();
+ *  \endcode
+ */
+template <typename CLK>
+class AdmissionController : public SampleObserver
+{
+  public:
+    enum { SLOTS_PER_INTERVAL = 4 };
+
+    /*! Start observing a timer
+     *
+     *  \param target     Objective for the latency percentile (seconds)
+     *  \param quantile   Percentile to which the objective applies
+     *  \param interval   Control interval (seconds), roughly the time
+     *                    within which load should respond to shedding
+     *  \param maxReject  Largest fraction of requests ever rejected,
+     *                    so that latency continues to be measured
+     */
+    AdmissionController(RegistryEntry& timer, double target,
+                        double quantile=0.99, double interval=0.1,
+                        double maxReject=0.95, unsigned minSamples=20)
+      : entry(timer), window(target, interval / SLOTS_PER_INTERVAL),
+        tolerance(1.0 - quantile), rejectCap(maxReject),
+        samplesNeeded(minSamples), admitLevel(ADMIT_ALL),
+        lastEpoch(0), slotsAbove(0), drops(0.0), reject(0.0) {
+      updating.clear();
+      if (!entry.setObserver(this)) {
+        throw std::logic_error("rtimers::AdmissionController timer "
+                               + entry.name + " is already observed");
+      }
+    }
+
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+    ~AdmissionController() {
+      entry.setObserver(NULL);
+    }
+
+    //! Decide whether to accept a new request
+    bool shouldAdmit() const {
+      const uint32_t level = admitLevel.load(std::memory_order_relaxed);
+      return (level == ADMIT_ALL || nextRandom() < level);
+    }
+
+    //! Fraction of requests currently being rejected
+    double getRejectFraction() const {
+      return 1.0 - double(admitLevel.load(std::memory_order_relaxed))
+                    / ADMIT_ALL;
+    }
+
+    void observe(double dt) {
+      const long ep = window.add(dt);
+      long prev = lastEpoch.load(std::memory_order_relaxed);
+
+      if (ep > prev
+          && lastEpoch.compare_exchange_strong(prev, ep,
+                                               std::memory_order_relaxed)
+          && !updating.test_and_set(std::memory_order_acquire)) {
+        update(ep);
+        updating.clear(std::memory_order_release);
+      }
+    }
+
+  protected:
+    static const uint32_t ADMIT_ALL = 0xffffffffu;
+
+    RegistryEntry& entry;
+    LatencyWindow<CLK> window;
+    const double tolerance;     //!< Fraction of samples allowed over target
+    const double rejectCap;
+    const unsigned samplesNeeded;
+    std::atomic<uint32_t> admitLevel;   //!< Admission probability * 2^32
+    std::atomic<long> lastEpoch;
+    std::atomic_flag updating;
+
+    // State owned by whichever thread is running update():
+    unsigned slotsAbove;        //!< Consecutive slots with target exceeded
+    double drops;               //!< Count driving the rejection fraction
+    double reject;
+
+    void update(long ep) {
+      const typename LatencyWindow<CLK>::Totals recent =
+                                    window.recent(ep, SLOTS_PER_INTERVAL);
+      const bool above = (recent.count >= samplesNeeded
+                          && recent.over > tolerance * recent.count);
+
+      if (above) {
+        ++slotsAbove;
+        if (slotsAbove >= SLOTS_PER_INTERVAL) drops += 1.0;
+      } else {
+        slotsAbove = 0;
+        drops = std::max(0.0, drops - 0.5);
+      }
+
+      reject = (drops > 0.0 ? std::min(rejectCap, 0.1 * std::sqrt(drops))
+                            : 0.0);
+      admitLevel.store(reject > 0.0 ? uint32_t((1.0 - reject) * ADMIT_ALL)
+                                    : ADMIT_ALL,
+                       std::memory_order_relaxed);
+    }
+
+    //! Cheap per-thread pseudo-random number (xorshift)
+    static uint32_t nextRandom() {
+      static thread_local uint32_t state = 0;
+
+      // Seed each thread differently, from the address of its own state:
+      if (state == 0) {
+        uint64_t seed = reinterpret_cast<uintptr_t>(&state)
+                        * 0x9e3779b97f4a7c15ull;
+        state = uint32_t(seed ^ (seed >> 32)) | 1u;
+      }
+
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      return state;
+    }
+};
+
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_ADMISSION_HPP */
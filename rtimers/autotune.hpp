@@ -0,0 +1,240 @@
+/*
+ *  Offline tuning of numerical parameters by measurement
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_AUTOTUNE_HPP
+#define _RTIMERS_AUTOTUNE_HPP
+
+#if __cplusplus < 201100
+#  error "rtimers/autotune requires C++11 support"
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core.hpp"
+
+
+namespace rtimers {
+
+//! A choice of value for each named tuning parameter
+typedef std::map<std::string, long> TuningConfig;
+
+
+/** Set of permitted values for each of several tuning parameters
+ *
+ *  Points in the space are numbered from zero, with the first parameter
+ *  varying fastest.
+ */
+class ParameterSpace
+{
+  public:
+    //! Declare a parameter and its candidate values
+    ParameterSpace& add(const std::string& name,
+                        const std::vector<long>& values) {
+      names.push_back(name);
+      choices.push_back(values);
+      return *this;
+    }
+
+    //! The total number of points in the space
+    size_t size() const {
+      size_t n = (names.empty() ? 0 : 1);
+      for (auto& values : choices) n *= values.size();
+      return n;
+    }
+
+    //! Find the configuration at a given point
+    TuningConfig at(size_t index) const {
+      TuningConfig config;
+
+      for (size_t i=0; i<names.size(); ++i) {
+        config[names[i]] = choices[i][index % choices[i].size()];
+        index /= choices[i].size();
+      }
+      return config;
+    }
+
+  protected:
+    std::vector<std::string> names;
+    std::vector<std::vector<long> > choices;
+};
+
+
+/** Measured execution times for a single point in a parameter space */
+struct TuningTrial
+{
+  TuningConfig config;
+  std::vector<double> times;
+
+  //! Median time, which is insensitive to occasional interruptions
+  double median() const {
+    if (times.empty()) return 1e18;
+
+    std::vector<double> sorted(times);
+    std::sort(sorted.begin(), sorted.end());
+    const size_t mid = sorted.size() / 2;
+    return (sorted.size() % 2 ? sorted[mid]
+                              : 0.5 * (sorted[mid - 1] + sorted[mid]));
+  }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const TuningTrial& trial) {
+  const double med = trial.median();
+  const TimeUnit tu = BoundStats::guessUnit(med);
+
+  for (auto& param : trial.config) {
+    os << param.first << "=" << param.second << " ";
+  }
+  os << "median = " << (med * tu.mult) << tu.unit
+     << " (n=" << trial.times.size() << ")";
+  return os;
+}
+
+
+/** Search for the fastest configuration of a tunable workload
+ *
+ *  The workload is called with a TuningConfig for each point visited,
+ *  once untimed to warm caches, and then repeatedly, with the median time
+ *  of those repetitions being used as the score. Points can be visited
+ *  exhaustively (GRID), as a random subset (RANDOM), or by successive
+ *  halving (HALVING), in which a random subset is measured briefly,
+ *  and the faster half repeatedly retained and measured with twice as many
+ *  further repetitions, until two points remain.
+ *  The best configuration can be saved to a file, for the application
+ *  to load when it starts.
+ *  \code
+ *  ParameterSpace space;
+ *  space.add("tile", { 16, 32, 64, 128 }).add("threads", { 1, 2, 4, 8 });
+ *  typedef Autotuner<cxx11::HiResClock> Tuner;
+ *  Tuner tuner(space, Tuner::HALVING);
+ *  const TuningConfig best = tuner.tune([](const TuningConfig& cfg) {
+ *      multiply(cfg.at("tile"), cfg.at("threads")); });
+ *  saveTuning("multiply.cfg", best);
+ *  ...
+ *  const TuningConfig cfg = loadTuning("multiply.cfg", defaults);
+ *  \endcode
+ */
+template <typename CLK>
+class Autotuner
+{
+  public:
+    enum Strategy { GRID, RANDOM, HALVING };
+
+    Autotuner(const ParameterSpace& sp, Strategy strat=GRID,
+              unsigned reps=5, unsigned maxPoints=32, unsigned seed=5489u)
+      : space(sp), strategy(strat), repetitions(std::max(reps, 1u)),
+        points(maxPoints), rng(seed) {}
+
+    //! Measure the workload across the parameter space, returning the best
+    template <typename FN>
+    TuningConfig tune(FN fn) {
+      std::vector<size_t> indices(space.size());
+      for (size_t i=0; i<indices.size(); ++i) indices[i] = i;
+      if (strategy != GRID) {
+        std::shuffle(indices.begin(), indices.end(), rng);
+        if (indices.size() > points) indices.resize(points);
+      }
+
+      trials.clear();
+      for (size_t i=0; i<indices.size(); ++i) {
+        trials.push_back(TuningTrial{ space.at(indices[i]), {} });
+      }
+
+      std::vector<TuningTrial*> active;
+      for (auto& trial : trials) active.push_back(&trial);
+
+      unsigned reps = repetitions;
+      for (;;) {
+        for (auto trial : active) measure(fn, *trial, reps);
+        sortByMedian(active);
+
+        if (strategy != HALVING || active.size() <= 2) break;
+        active.resize((active.size() + 1) / 2);
+        reps *= 2;
+      }
+
+      return (active.empty() ? TuningConfig() : active.front()->config);
+    }
+
+    //! All points measured, including those abandoned by successive halving
+    const std::vector<TuningTrial>& getTrials() const {
+      return trials;
+    }
+
+  protected:
+    const ParameterSpace space;
+    const Strategy strategy;
+    const unsigned repetitions;
+    const unsigned points;
+    std::mt19937 rng;
+    std::vector<TuningTrial> trials;
+
+    template <typename FN>
+    void measure(FN& fn, TuningTrial& trial, unsigned reps) {
+      if (trial.times.empty()) fn(trial.config);
+
+      for (unsigned r=0; r<reps; ++r) {
+        const typename CLK::Instant t0 = CLK::now();
+        fn(trial.config);
+        trial.times.push_back(CLK::interval(t0, CLK::now()));
+      }
+    }
+
+    static void sortByMedian(std::vector<TuningTrial*>& active) {
+      std::stable_sort(active.begin(), active.end(),
+                       [](const TuningTrial* a, const TuningTrial* b) {
+                         return a->median() < b->median(); });
+    }
+};
+
+
+//! Write a configuration to a file, as lines of "name = value"
+inline bool saveTuning(const std::string& path, const TuningConfig& config) {
+  std::ofstream strm(path.c_str());
+
+  strm << "# rtimers tuned configuration\n";
+  for (auto& param : config) {
+    strm << param.first << " = " << param.second << "\n";
+  }
+  return strm.good();
+}
+
+
+/** Read a configuration saved by saveTuning()
+ *
+ *  \return The supplied defaults, overridden by any values in the file
+ */
+inline TuningConfig loadTuning(const std::string& path,
+                               const TuningConfig& defaults=TuningConfig()) {
+  TuningConfig config(defaults);
+  std::ifstream strm(path.c_str());
+  std::string line;
+
+  while (std::getline(strm, line)) {
+    const size_t eq = line.find('=');
+    if (line.empty() || line[0] == '#' || eq == std::string::npos) continue;
+
+    std::istringstream name(line.substr(0, eq)), value(line.substr(eq + 1));
+    std::string key;
+    long val;
+    if ((name >> key) && (value >> val)) config[key] = val;
+  }
+
+  return config;
+}
+
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_AUTOTUNE_HPP */
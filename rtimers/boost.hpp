@@ -70,15 +70,17 @@ class ThreadManager : boost::noncopyable
       timemap->insert(itr, { this, CLK::now() });
     }
 
-    //! Note the time the stopwatch was stopped, and accumulate statistics
-    void updateStats(const Instant& now, STATS& stats) {
+    //! Note the stop time, accumulate statistics, and return the interval
+    double updateStats(const Instant& now, STATS& stats) {
       TimeMap* timemap = startTimes.get();
       const double duration = CLK::interval(timemap->at(this), now);
 
       {
         boost::mutex::scoped_lock lock(stats_mtx);
-        stats.addSample(duration);
+        addTimedSample(stats, duration, now);
       }
+
+      return duration;
     }
 
   protected:
@@ -0,0 +1,298 @@
+/*
+ *  Cross-core clock consistency and drift relative to system clocks
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_CLOCKCHECK_HPP
+#define _RTIMERS_CLOCKCHECK_HPP
+
+#if __cplusplus < 201100
+#  error "rtimers/clockcheck requires C++11 support"
+#endif
+#if !defined(__linux)
+#  error "rtimers/clockcheck requires Linux thread affinity"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+#include "core.hpp"
+
+
+namespace rtimers {
+
+
+//! Estimated offset of one CPU's clock readings relative to a reference CPU
+struct CoreSkew
+{
+  int cpu;
+  double offset;      //!< Reading on this CPU minus simultaneous reference
+  double roundTrip;   //!< Smallest ping-pong time, bounding the uncertainty
+};
+
+
+/** Simultaneous readings of a fast clock and the kernel's clocks */
+struct ClockAnchor
+{
+  double fast;        //!< Seconds since calibrator was created, via CLK
+  double monotonic;   //!< CLOCK_MONOTONIC (seconds)
+  double realtime;    //!< CLOCK_REALTIME (seconds since 1970)
+  double window;      //!< Time taken to read all three clocks
+};
+
+
+/** Mapping of fast-clock timestamps onto monotonic and wall-clock time
+ *
+ *  Timestamps from a fast clock (such as cxx11::HiResClock) are only
+ *  useful for merging with external logs if they can be converted
+ *  into wall-clock time. This records a table of anchors, each being
+ *  a tightly bracketed reading of the fast clock, CLOCK_MONOTONIC
+ *  and CLOCK_REALTIME, which should be refreshed periodically via anchor().
+ *  Timestamps are then converted by interpolating between the
+ *  neighbouring anchors, so that drift between the clocks,
+ *  or steps in CLOCK_REALTIME, are accounted for.
+ *  Once the table reaches its size limit, every other anchor is
+ *  discarded, so that it still spans the calibrator's whole lifetime,
+ *  at a coarser resolution. Anchors may be added by one thread while
+ *  others convert timestamps.
+ *  measureSkew() checks whether readings of the fast clock taken
+ *  on different CPUs are mutually consistent.
+ *  \code
+ *  ClockCalibrator<cxx11::HiResClock> calib;
+ *  ...
+ *  calib.anchor();     // e.g. once per second
+ *  const double wall = calib.toRealtime(someInstant);
+ *  \endcode
+ */
+template <typename CLK>
+class ClockCalibrator
+{
+  public:
+    typedef typename CLK::Instant Instant;
+
+    /*! Create a calibrator, and record its first anchor
+     *
+     *  \param tries       Readings from which each anchor is chosen
+     *  \param maxAnchors  Size at which the table of anchors is thinned
+     */
+    ClockCalibrator(unsigned tries=16, size_t maxAnchors=1024)
+      : origin(CLK::now()), attempts(tries),
+        anchorLimit(std::max(maxAnchors, size_t(2))) {
+      anchor();
+    }
+
+    //! Record a new anchor, returning its time-window (in seconds)
+    double anchor() {
+      ClockAnchor best = { 0.0, 0.0, 0.0, 1e18 };
+
+      for (unsigned i=0; i<attempts; ++i) {
+        const double r0 = readClock(CLOCK_REALTIME);
+        const double m = readClock(CLOCK_MONOTONIC);
+        const double f = sinceOrigin(CLK::now());
+        const double r1 = readClock(CLOCK_REALTIME);
+
+        if ((r1 - r0) < best.window) {
+          best.fast = f;
+          best.monotonic = m;
+          best.realtime = 0.5 * (r0 + r1);
+          best.window = r1 - r0;
+        }
+      }
+
+      std::lock_guard<std::mutex> lock(mtx);
+      anchors.push_back(best);
+      if (anchors.size() > anchorLimit) thin();
+      return best.window;
+    }
+
+    //! Copy the table of anchors, in order of increasing time
+    std::vector<ClockAnchor> getAnchors() const {
+      std::lock_guard<std::mutex> lock(mtx);
+      return anchors;
+    }
+
+    //! Seconds elapsed between the calibrator's creation and a timestamp
+    double sinceOrigin(const Instant& t) const {
+      return CLK::interval(origin, t);
+    }
+
+    //! Convert a fast-clock timestamp into CLOCK_REALTIME seconds
+    double toRealtime(const Instant& t) const {
+      return convert(sinceOrigin(t), &ClockAnchor::realtime);
+    }
+
+    //! Convert a fast-clock timestamp into CLOCK_MONOTONIC seconds
+    double toMonotonic(const Instant& t) const {
+      return convert(sinceOrigin(t), &ClockAnchor::monotonic);
+    }
+
+    /*! Rate at which the fast clock gains on CLOCK_MONOTONIC
+     *
+     *  \return Drift, in parts per million, between the first and last anchors
+     */
+    double driftPPM() const {
+      std::lock_guard<std::mutex> lock(mtx);
+      if (anchors.size() < 2) return 0.0;
+
+      const ClockAnchor& a = anchors.front();
+      const ClockAnchor& b = anchors.back();
+      const double dm = b.monotonic - a.monotonic;
+      return (dm > 0.0 ? 1e6 * ((b.fast - a.fast) / dm - 1.0) : 0.0);
+    }
+
+    //! Write the table of anchors as comma-separated values
+    void writeTable(std::ostream& os) const {
+      std::lock_guard<std::mutex> lock(mtx);
+      const std::streamsize prec = os.precision(17);
+
+      os << "fast,monotonic,realtime,window\n";
+      for (size_t i=0; i<anchors.size(); ++i) {
+        const ClockAnchor& a = anchors[i];
+        os << a.fast << "," << a.monotonic << ","
+           << a.realtime << "," << a.window << "\n";
+      }
+
+      os.precision(prec);
+    }
+
+    /*! Estimate fast-clock offsets of each usable CPU relative to another
+     *
+     *  A thread pinned to the reference CPU repeatedly exchanges messages
+     *  with a thread pinned to each other CPU in turn, and the offset is
+     *  estimated from the exchange with the smallest round-trip time,
+     *  assuming that the reply was sent half-way through that exchange.
+     */
+    static std::vector<CoreSkew> measureSkew(int reference=-1,
+                                             unsigned rounds=1000) {
+      std::vector<CoreSkew> skews;
+      const std::vector<int> cpus = usableCPUs();
+      if (cpus.empty()) return skews;
+      if (reference < 0) reference = cpus.front();
+
+      for (size_t i=0; i<cpus.size(); ++i) {
+        if (cpus[i] == reference) continue;
+        skews.push_back(pingPong(reference, cpus[i], rounds));
+      }
+
+      return skews;
+    }
+
+  protected:
+    const Instant origin;
+    const unsigned attempts;
+    const size_t anchorLimit;
+    mutable std::mutex mtx;     //!< Protects the table of anchors
+    std::vector<ClockAnchor> anchors;
+
+    static double readClock(clockid_t clk) {
+      timespec t;
+      clock_gettime(clk, &t);
+      return t.tv_sec + 1e-9 * t.tv_nsec;
+    }
+
+    //! Interpolate (or extrapolate) a field of the anchor table
+    double convert(double fast, double ClockAnchor::*field) const {
+      std::lock_guard<std::mutex> lock(mtx);
+      if (anchors.size() < 2) {
+        return anchors.front().*field + (fast - anchors.front().fast);
+      }
+
+      // Find the first anchor (excluding the ends) not before the timestamp:
+      const auto hi = std::lower_bound(anchors.begin() + 1, anchors.end() - 1,
+                          fast, [](const ClockAnchor& anc, double when) {
+                                  return anc.fast < when; });
+      const ClockAnchor& a = *(hi - 1);
+      const ClockAnchor& b = *hi;
+
+      const double span = b.fast - a.fast;
+      const double slope = (span > 0.0 ? (b.*field - a.*field) / span : 1.0);
+      return a.*field + slope * (fast - a.fast);
+    }
+
+    //! Discard every other anchor, keeping both the first and last
+    void thin() {
+      std::vector<ClockAnchor> kept;
+      for (size_t i=0; i<anchors.size(); i+=2) kept.push_back(anchors[i]);
+      if ((anchors.size() % 2) == 0) kept.push_back(anchors.back());
+      anchors.swap(kept);
+    }
+
+    static std::vector<int> usableCPUs() {
+      std::vector<int> cpus;
+      cpu_set_t mask;
+
+      if (sched_getaffinity(0, sizeof(mask), &mask) != 0) return cpus;
+      for (int c=0; c<CPU_SETSIZE; ++c) {
+        if (CPU_ISSET(c, &mask)) cpus.push_back(c);
+      }
+      return cpus;
+    }
+
+    static void pin(int cpu) {
+      cpu_set_t mask;
+      CPU_ZERO(&mask);
+      CPU_SET(cpu, &mask);
+      pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+    }
+
+    static CoreSkew pingPong(int reference, int cpu, unsigned rounds) {
+      const Instant origin = CLK::now();
+      std::atomic<unsigned> ping(0), pong(0);
+      std::atomic<double> remote(0.0);
+      CoreSkew skew = { cpu, 0.0, 1e18 };
+
+      std::thread responder([&]() {
+        pin(cpu);
+        for (unsigned r=1; r<=rounds; ++r) {
+          while (ping.load(std::memory_order_acquire) != r) {}
+          remote.store(CLK::interval(origin, CLK::now()),
+                       std::memory_order_relaxed);
+          pong.store(r, std::memory_order_release);
+        }
+      });
+
+      std::thread initiator([&]() {
+        pin(reference);
+        for (unsigned r=1; r<=rounds; ++r) {
+          const double t0 = CLK::interval(origin, CLK::now());
+          ping.store(r, std::memory_order_release);
+          while (pong.load(std::memory_order_acquire) != r) {}
+          const double t1 = CLK::interval(origin, CLK::now());
+
+          if ((t1 - t0) < skew.roundTrip) {
+            skew.roundTrip = t1 - t0;
+            skew.offset = remote.load(std::memory_order_relaxed)
+                            - 0.5 * (t0 + t1);
+          }
+        }
+      });
+
+      initiator.join();
+      responder.join();
+
+      return skew;
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const CoreSkew& skew) {
+  const TimeUnit tu = BoundStats::guessUnit(skew.roundTrip);
+
+  os << "cpu" << skew.cpu << ": offset = " << (skew.offset * tu.mult) << tu.unit
+     << " +/- " << (0.5 * skew.roundTrip * tu.mult) << tu.unit;
+  return os;
+}
+
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_CLOCKCHECK_HPP */
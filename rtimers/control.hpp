@@ -0,0 +1,278 @@
+/*
+ *  Live reconfiguration of registered timers via a control file
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_CONTROL_HPP
+#define _RTIMERS_CONTROL_HPP
+
+#if __cplusplus < 201100
+#  error "rtimers/control requires C++11 support"
+#endif
+
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <mutex>
+#include <poll.h>
+#include <signal.h>
+#include <sstream>
+#include <string>
+#include <sys/inotify.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "core.hpp"
+#include "registry.hpp"
+
+
+namespace rtimers {
+
+
+/** Watcher which reconfigures registered timers from a control file
+ *
+ *  The control file is re-read whenever it is rewritten or renamed
+ *  into place (detected via inotify), or when the process receives
+ *  a signal (SIGUSR2 by default) after handleSignal() has been called.
+ *  Each line of the file is one of:
+ *    - "enable PREFIX" or "disable PREFIX"
+ *    - "sample PREFIX PERIOD": record only one in every PERIOD samples,
+ *      which is rounded up to a power of two
+ *    - "trace PREFIX" or "notrace PREFIX": write ftrace begin/end records
+ *      (if ftrace::TraceMarker::global() has been opened)
+ *    - "dump": report the statistics of all timers via LOG
+ *
+ *  where PREFIX selects timers by the start of their names,
+ *  or "*" selects all timers. Later lines take precedence, and timers
+ *  not selected by any line revert to being enabled, untraced and
+ *  fully sampled. The whole file is parsed before any changes are made,
+ *  and each timer's new flags are then stored as a single word,
+ *  which is the same word already loaded on each call by
+ *  RegistryEntry::addSample(), so reconfiguration adds no per-call cost.
+ *  The rules are kept by the Registry, so timers created after a reload
+ *  also take the flags which it selects for them.
+ *  Sampled timers count each recorded sample once per period,
+ *  so their counts and totals estimate those of all samples.
+ *  \code
+ *  TimerControl<> control(Registry::global(), "/run/myapp/timers.ctl");
+ *  control.handleSignal();
+ *  \endcode
+ */
+template <typename LOG=StderrLogger>
+class TimerControl
+{
+  public:
+    TimerControl(Registry& reg, const std::string& controlPath)
+      : registry(reg), path(controlPath), watchFd(-1),
+        reloads(0), prevAction(), signalled(0) {
+      wakePipe[0] = wakePipe[1] = -1;
+      if (::pipe2(wakePipe, O_NONBLOCK | O_CLOEXEC) != 0) return;
+
+      watchFd = ::inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+      if (watchFd >= 0) {
+        const size_t slash = path.rfind('/');
+        const std::string dir = (slash == std::string::npos ? "."
+                                  : path.substr(0, std::max<size_t>(slash, 1)));
+        fileName = path.substr(slash == std::string::npos ? 0 : slash + 1);
+        if (::inotify_add_watch(watchFd, dir.c_str(),
+                                IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+          ::close(watchFd);
+          watchFd = -1;
+        }
+      }
+
+      reload();
+      watcher = std::thread([this]() { watch(); });
+    }
+
+    TimerControl(const TimerControl&) = delete;
+    TimerControl& operator=(const TimerControl&) = delete;
+
+    ~TimerControl() {
+      if (signalled) {
+        signalFd().store(-1);
+        ::sigaction(signalled, &prevAction, NULL);
+      }
+      if (watcher.joinable()) {
+        if (::write(wakePipe[1], "q", 1) != 1) {}
+        watcher.join();
+      }
+      if (watchFd >= 0) ::close(watchFd);
+      if (wakePipe[0] >= 0) ::close(wakePipe[0]);
+      if (wakePipe[1] >= 0) ::close(wakePipe[1]);
+    }
+
+    //! Re-read the control file whenever a given signal is received
+    bool handleSignal(int sig=SIGUSR2) {
+      if (wakePipe[1] < 0 || signalled) return false;
+
+      struct sigaction action;
+      std::memset(&action, 0, sizeof(action));
+      action.sa_handler = &TimerControl::onSignal;
+      sigemptyset(&action.sa_mask);
+      action.sa_flags = SA_RESTART;
+
+      signalFd().store(wakePipe[1]);
+      if (::sigaction(sig, &action, &prevAction) != 0) {
+        signalFd().store(-1);
+        return false;
+      }
+      signalled = sig;
+      return true;
+    }
+
+    //! Read and apply the control file, returning false if it is unusable
+    bool reload() {
+      std::ifstream strm(path.c_str());
+      if (!strm) return false;
+
+      std::ostringstream content;
+      content << strm.rdbuf();
+      return apply(content.str());
+    }
+
+    //! Apply the text of a control file, unless it contains errors
+    bool apply(const std::string& config) {
+      std::vector<RegistryRule> rules;
+      bool dump = false;
+      if (!parse(config, rules, dump)) return false;
+
+      std::lock_guard<std::mutex> lock(mtx);
+      registry.setRules(rules);
+
+      if (dump) {
+        const RegistrySnapshot snap = registry.snapshot();
+        for (auto& timer : snap.timers) LOG::report(timer.first, timer.second);
+      }
+
+      reloads.fetch_add(1, std::memory_order_release);
+      return true;
+    }
+
+    //! Number of times the control file has been successfully applied
+    unsigned long getReloads() const {
+      return reloads.load(std::memory_order_acquire);
+    }
+
+    //! Check whether changes to the control file will be noticed
+    bool isWatching() const {
+      return watchFd >= 0;
+    }
+
+  protected:
+    Registry& registry;
+    const std::string path;
+    std::string fileName;
+    int watchFd;
+    int wakePipe[2];
+    std::atomic<unsigned long> reloads;
+    struct sigaction prevAction;
+    int signalled;
+    std::mutex mtx;
+    std::thread watcher;
+
+    static bool parse(const std::string& config,
+                      std::vector<RegistryRule>& rules, bool& dump) {
+      std::istringstream lines(config);
+      std::string line;
+
+      while (std::getline(lines, line)) {
+        std::istringstream words(line);
+        std::string command, prefix;
+        if (!(words >> command) || command[0] == '#') continue;
+
+        if (command == "dump") {
+          dump = true;
+          continue;
+        }
+        if (!(words >> prefix)) return false;
+
+        RegistryRule rule{ (prefix == "*" ? "" : prefix), -1, -1, -1 };
+        if (command == "enable" || command == "disable") {
+          rule.enabled = (command == "enable");
+        } else if (command == "trace" || command == "notrace") {
+          rule.traced = (command == "trace");
+        } else if (command == "sample") {
+          unsigned long period = 0;
+          if (!(words >> period) || period == 0) return false;
+          rule.logPeriod = 0;
+          while ((1ul << rule.logPeriod) < period
+                 && rule.logPeriod < 31) ++rule.logPeriod;
+        } else {
+          return false;
+        }
+        rules.push_back(rule);
+      }
+
+      return true;
+    }
+
+    void watch() {
+      pollfd fds[2];
+      fds[0].fd = wakePipe[0];
+      fds[1].fd = watchFd;
+      const nfds_t nfds = (watchFd >= 0 ? 2 : 1);
+
+      for (;;) {
+        fds[0].events = fds[1].events = POLLIN;
+        fds[0].revents = fds[1].revents = 0;
+        if (::poll(fds, nfds, -1) < 0) continue;
+        bool changed = false;
+
+        if (fds[0].revents) {
+          char buff[64];
+          bool quit = false;
+          ssize_t n;
+          while ((n = ::read(wakePipe[0], buff, sizeof(buff))) > 0) {
+            if (std::memchr(buff, 'q', n)) quit = true;
+          }
+          if (quit) break;
+          changed = true;
+        }
+        if (nfds > 1 && fds[1].revents) changed |= fileChanged();
+
+        if (changed) reload();
+      }
+    }
+
+    //! Consume inotify events, checking whether any concern the control file
+    bool fileChanged() {
+      alignas(inotify_event) char buff[4096];
+      bool found = false;
+      ssize_t n;
+
+      while ((n = ::read(watchFd, buff, sizeof(buff))) > 0) {
+        for (ssize_t pos = 0; pos < n; ) {
+          const inotify_event* event =
+                        reinterpret_cast<const inotify_event*>(buff + pos);
+          if (event->len > 0 && fileName == event->name) found = true;
+          pos += sizeof(inotify_event) + event->len;
+        }
+      }
+
+      return found;
+    }
+
+    static std::atomic<int>& signalFd() {
+      static std::atomic<int> fd(-1);
+      return fd;
+    }
+
+    static void onSignal(int) {
+      const int fd = signalFd().load();
+      if (fd >= 0) {
+        if (::write(fd, "s", 1) != 1) {}
+      }
+    }
+};
+
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_CONTROL_HPP */
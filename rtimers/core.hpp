@@ -18,6 +18,10 @@
 #  include <memory>
 #endif
 
+#if defined(RTIMERS_HAVE_USDT) && RTIMERS_HAVE_USDT
+#  include "usdt.hpp"
+#endif
+
 
 namespace rtimers {
 
@@ -42,6 +46,28 @@ STATS clockZeroError(unsigned iterations=1000) {
 }
 
 
+/** Hook allowing a timer-statistics controller to learn its timer's label
+ *
+ *  This default does nothing, but managers which need the label
+ *  (e.g. for emitting trace records) can provide a more specialized
+ *  overload within their own namespace.
+ */
+template <typename MGR>
+void attachIdent(MGR& mgr, const std::string& ident) {}
+
+
+/** Hook allowing a statistics accumulator to see when a sample was taken
+ *
+ *  Managers pass the stop time which they have already read from the clock,
+ *  which this default ignores, but accumulators which bin samples
+ *  by time (e.g. HeatmapStats) can provide a more specialized overload.
+ */
+template <typename STATS, typename INSTANT>
+void addTimedSample(STATS& stats, double dt, const INSTANT& when) {
+  stats.addSample(dt);
+}
+
+
 /** Mechanism for automatically starting and stopping a timer
  *
  *  \see Timer::scopedStart()
@@ -71,6 +97,8 @@ class ScopedStartStop
  *  can be customized.
  *
  *  It is assumed that all time-intervals are stored in units of seconds.
+ *  A manager's updateStats() may return the measured interval,
+ *  which is then passed to any USDT probe, or may return nothing.
  *
  *  \see NullManager, SerialManager, StderrLogger
  */
@@ -84,20 +112,31 @@ class Timer : protected MGR
     typedef ScopedStartStop<self_t> Scoper;
 
     Timer(const std::string& name)
-      : ident(name) {}
+      : ident(name) {
+      attachIdent(static_cast<MGR&>(*this), ident);
+    }
     ~Timer() {
       LOG::report(ident, stats);
     }
 
     //! Start the clock running
     void start() {
+#if RTIMERS_HAVE_USDT
+      RTIMERS_PROBE_TIMER_START(this, ident);
+#endif
       MGR::recordStart(MGR::ClockProvider::now());
     }
 
     //! Stop the clock and accumulate time interval statistics
     void stop() {
       const Instant stopTime = MGR::ClockProvider::now();
+#if RTIMERS_HAVE_USDT
+      const usdt::Duration duration = (MGR::updateStats(stopTime, stats),
+                                       usdt::Duration());
+      RTIMERS_PROBE_TIMER_STOP(this, ident, duration.seconds);
+#else
       MGR::updateStats(stopTime, stats);
+#endif
     }
 
     //! Create object which will start & stop the clock when in scope
@@ -110,6 +149,11 @@ class Timer : protected MGR
       return stats;
     }
 
+    //! Get modifiable statistics, e.g. for configuration (not thread safe)
+    Stats& getStats() {
+      return stats;
+    }
+
     /*! Estimate time delay between adjacent queries of system clock
      *
      *  \see MeanBoundStats
@@ -166,7 +210,9 @@ struct NullManager
   };
 
   void recordStart(const Instant& now) {}
-  void updateStats(const Instant& now, StatsAccumulator& stats) {}
+  double updateStats(const Instant& now, StatsAccumulator& stats) {
+    return 0.0;
+  }
 };
 
 
@@ -186,10 +232,11 @@ struct SerialManager
     startTime = now;
   }
 
-  //! Note the time the stopwatch was stopped, and accumulate statistics
-  void updateStats(const Instant& now, STATS& stats) {
+  //! Note the stop time, accumulate statistics, and return the interval
+  double updateStats(const Instant& now, STATS& stats) {
     const double duration = CLK::interval(startTime, now);
-    stats.addSample(duration);
+    addTimedSample(stats, duration, now);
+    return duration;
   }
 
   //! Most recent start time
@@ -321,7 +368,7 @@ struct LogBoundStats : public BoundStats
   void addSample(double dt) {
     BoundStats::addSample(dt);
 
-    const double delta = std::log(std::max(dt, tinyTime)) - logMean;
+    const double delta = std::log(std::max(dt, double(tinyTime))) - logMean;
     logMean += delta / count;
     nLogVariance += ((count - 1) * delta) * delta / count;
   }
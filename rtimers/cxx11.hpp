@@ -77,14 +77,16 @@ class ThreadManager
       startTimes.insert(itr, { this, CLK::now() });
     }
 
-    //! Note the time the stopwatch was stopped, and accumulate statistics
-    void updateStats(const Instant& now, STATS& stats) {
+    //! Note the stop time, accumulate statistics, and return the interval
+    double updateStats(const Instant& now, STATS& stats) {
       const double duration = CLK::interval(startTimes.at(this), now);
 
       {
         std::lock_guard<std::mutex> lock(stats_mtx);
-        stats.addSample(duration);
+        addTimedSample(stats, duration, now);
       }
+
+      return duration;
     }
 
   protected:
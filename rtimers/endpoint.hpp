@@ -0,0 +1,277 @@
+/*
+ *  Query service for registered timers via a Unix-domain socket
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_ENDPOINT_HPP
+#define _RTIMERS_ENDPOINT_HPP
+
+#if __cplusplus < 201100
+#  error "rtimers/endpoint requires C++11 support"
+#endif
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <poll.h>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+#include "core.hpp"
+#include "registry.hpp"
+
+
+namespace rtimers {
+
+
+/** Background service answering queries about a Registry
+ *
+ *  A thread listens on a Unix-domain socket, and for each connection
+ *  reads a single line of request, writes a textual response,
+ *  and closes the connection. The requests are:
+ *    - "list": the name of each timer, and whether it is enabled
+ *    - "stats PREFIX": statistics of timers whose names start with PREFIX
+ *    - "reset PREFIX": discard the statistics of matching timers
+ *    - "enable PREFIX", "disable PREFIX": start or stop accepting samples
+ *
+ *  An omitted prefix matches all timers. Statistics are read from
+ *  a snapshot of the registry, which never blocks timed threads
+ *  for longer than it takes to copy one shard.
+ *  The socket is accessible only to the owning user, and a client
+ *  which does not send its request, or read its response, within
+ *  a timeout is disconnected, so cannot stall other clients.
+ *  \code
+ *  StatsEndpoint endpoint(Registry::global(), "/run/myapp/timers.sock");
+ *  \endcode
+ *  and then, from a shell:
+ *  \code
+ *  rtquery /run/myapp/timers.sock stats db.
+ *  \endcode
+ */
+class StatsEndpoint
+{
+  public:
+    StatsEndpoint(Registry& reg, const std::string& socketPath)
+      : registry(reg), path(socketPath), listenFd(-1) {
+      stopPipe[0] = stopPipe[1] = -1;
+
+      sockaddr_un addr;
+      if (!makeAddress(path, addr) || ::pipe(stopPipe) != 0) return;
+
+      // Replace a stale socket, but never any other kind of file:
+      struct stat info;
+      if (::lstat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+        ::unlink(path.c_str());
+      }
+
+      // Restrict access before any client can connect:
+      listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+      if (listenFd < 0
+          || ::bind(listenFd, reinterpret_cast<sockaddr*>(&addr),
+                    sizeof(addr)) != 0
+          || ::chmod(path.c_str(), S_IRUSR | S_IWUSR) != 0
+          || ::listen(listenFd, 8) != 0) {
+        closeAll();
+        return;
+      }
+
+      server = std::thread([this]() { serve(); });
+    }
+
+    StatsEndpoint(const StatsEndpoint&) = delete;
+    StatsEndpoint& operator=(const StatsEndpoint&) = delete;
+
+    ~StatsEndpoint() {
+      if (server.joinable()) {
+        if (::write(stopPipe[1], "x", 1) != 1) {}
+        server.join();
+        ::unlink(path.c_str());
+      }
+      closeAll();
+    }
+
+    //! Check whether the socket was created successfully
+    bool isListening() const {
+      return listenFd >= 0;
+    }
+
+    //! Produce the response to a single request
+    std::string answer(const std::string& request) {
+      const size_t sep = request.find(' ');
+      const std::string command = request.substr(0, sep);
+      const std::string prefix = (sep != std::string::npos
+                                    ? request.substr(sep + 1) : "");
+      std::ostringstream strm;
+
+      if (command == "list") {
+        for (auto entry : registry.matching(prefix)) {
+          strm << entry->name << "\t"
+               << (entry->isEnabled() ? "on" : "off") << "\n";
+        }
+      } else if (command == "stats") {
+        const RegistrySnapshot snap = registry.snapshot(prefix);
+        for (auto& timer : snap.timers) {
+          strm << "Timer(" << timer.first << "): " << timer.second << "\n";
+        }
+      } else if (command == "reset") {
+        const std::vector<RegistryEntry*> found = registry.matching(prefix);
+        for (auto entry : found) entry->reset();
+        strm << "reset " << found.size() << "\n";
+      } else if (command == "enable" || command == "disable") {
+        const std::vector<RegistryEntry*> found = registry.matching(prefix);
+        for (auto entry : found) entry->setEnabled(command == "enable");
+        strm << command << "d " << found.size() << "\n";
+      } else {
+        strm << "error: unknown request '" << command << "'\n";
+      }
+
+      return strm.str();
+    }
+
+    /*! Send a request to an endpoint, and collect its response
+     *
+     *  \return False if the endpoint could not be contacted
+     */
+    static bool query(const std::string& socketPath,
+                      const std::string& request, std::string& response) {
+      sockaddr_un addr;
+      if (!makeAddress(socketPath, addr)) return false;
+
+      const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+      if (fd < 0) return false;
+      if (::connect(fd, reinterpret_cast<sockaddr*>(&addr),
+                    sizeof(addr)) != 0) {
+        ::close(fd);
+        return false;
+      }
+
+      const std::string line = request + "\n";
+      const bool sent = sendAll(fd, line, -1);
+      ::shutdown(fd, SHUT_WR);
+
+      response.clear();
+      char buff[4096];
+      ssize_t n;
+      while ((n = ::read(fd, buff, sizeof(buff))) > 0) response.append(buff, n);
+      ::close(fd);
+
+      return sent;
+    }
+
+  protected:
+    enum { MAX_REQUEST = 4096, TIMEOUT_MS = 1000 };
+
+    Registry& registry;
+    const std::string path;
+    int listenFd;
+    int stopPipe[2];
+    std::thread server;
+
+    void serve() {
+      pollfd fds[2];
+      fds[0].fd = listenFd;
+      fds[1].fd = stopPipe[0];
+
+      for (;;) {
+        fds[0].events = fds[1].events = POLLIN;
+        fds[0].revents = fds[1].revents = 0;
+        if (::poll(fds, 2, -1) < 0) continue;
+        if (fds[1].revents) break;
+
+        const int conn = ::accept(listenFd, NULL, NULL);
+        if (conn < 0) continue;
+
+        std::string request;
+        if (readRequest(conn, request)) {
+          sendAll(conn, answer(request), TIMEOUT_MS);
+        }
+        ::close(conn);
+      }
+    }
+
+    //! Read one line from a client, without waiting indefinitely
+    static bool readRequest(int fd, std::string& request) {
+      pollfd pfd;
+      pfd.fd = fd;
+      pfd.events = POLLIN;
+      char buff[256];
+
+      while (request.size() < MAX_REQUEST) {
+        if (::poll(&pfd, 1, TIMEOUT_MS) <= 0) return false;
+
+        const ssize_t n = ::read(fd, buff, sizeof(buff));
+        if (n < 0) return false;
+        request.append(buff, n);
+
+        const size_t end = request.find('\n');
+        if (end != std::string::npos || n == 0) {
+          request = request.substr(0, end);
+          if (!request.empty() && request.back() == '\r') request.pop_back();
+          return true;
+        }
+      }
+      return false;
+    }
+
+    /*! Write a complete response, without waiting indefinitely
+     *
+     *  \param timeoutMs   Limit on the total time taken (or -1 for none)
+     */
+    static bool sendAll(int fd, const std::string& data, int timeoutMs) {
+      typedef std::chrono::steady_clock Clock;
+      const Clock::time_point deadline = Clock::now()
+                                  + std::chrono::milliseconds(timeoutMs);
+      pollfd pfd;
+      pfd.fd = fd;
+      pfd.events = POLLOUT;
+      size_t pos = 0;
+
+      while (pos < data.size()) {
+        int wait = -1;
+        if (timeoutMs >= 0) {
+          wait = int(std::chrono::duration_cast<std::chrono::milliseconds>(
+                        deadline - Clock::now()).count());
+          if (wait <= 0) return false;
+        }
+        if (::poll(&pfd, 1, wait) <= 0) return false;
+
+        const ssize_t n = ::send(fd, data.data() + pos, data.size() - pos,
+                                 MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+        if (n <= 0) return false;
+        pos += n;
+      }
+      return true;
+    }
+
+    static bool makeAddress(const std::string& socketPath, sockaddr_un& addr) {
+      std::memset(&addr, 0, sizeof(addr));
+      addr.sun_family = AF_UNIX;
+      if (socketPath.empty() || socketPath.size() >= sizeof(addr.sun_path)) {
+        return false;
+      }
+      std::strcpy(addr.sun_path, socketPath.c_str());
+      return true;
+    }
+
+    void closeAll() {
+      if (listenFd >= 0) ::close(listenFd);
+      if (stopPipe[0] >= 0) ::close(stopPipe[0]);
+      if (stopPipe[1] >= 0) ::close(stopPipe[1]);
+      listenFd = stopPipe[0] = stopPipe[1] = -1;
+    }
+};
+
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_ENDPOINT_HPP */
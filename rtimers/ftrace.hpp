@@ -0,0 +1,204 @@
+/*
+ *  Timer begin/end records written to the Linux ftrace trace_marker
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_FTRACE_HPP
+#define _RTIMERS_FTRACE_HPP
+
+#if __cplusplus < 201100
+#  error "rtimers/ftrace requires C++11 support"
+#endif
+
+#include <atomic>
+#include <fcntl.h>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+#include "core.hpp"
+
+
+namespace rtimers {
+  namespace ftrace {
+
+
+/** Persistent connection to the kernel's trace_marker file
+ *
+ *  The marker file descriptor is kept open, and the state of
+ *  the kernel's "tracing_on" switch is cached, being re-read
+ *  only once every few thousand queries by each thread,
+ *  or on demand via refresh(), so that isEnabled() is a plain load.
+ *  Both paths can be overridden, e.g. to direct records into
+ *  a plain file for testing; an empty enable-path means that
+ *  records are always written.
+ *  The file descriptors are atomic, but open() and close() should
+ *  still not be called while other threads may be writing records,
+ *  as a closed descriptor could be reused for an unrelated file.
+ *
+ *  \see TraceMarkerManager
+ */
+class TraceMarker
+{
+  public:
+    TraceMarker()
+      : markerFd(-1), enableFd(-1), enabled(false) {}
+    TraceMarker(const TraceMarker&) = delete;
+    TraceMarker& operator=(const TraceMarker&) = delete;
+    ~TraceMarker() {
+      close();
+    }
+
+    //! The marker shared by all TraceMarkerManager instances
+    static TraceMarker& global() {
+      static TraceMarker marker;
+      return marker;
+    }
+
+    //! Find the tracefs directory, preferring its modern mount-point
+    static std::string tracingDir() {
+      if (access("/sys/kernel/tracing/trace_marker", W_OK) == 0) {
+        return "/sys/kernel/tracing/";
+      }
+      return "/sys/kernel/debug/tracing/";
+    }
+
+    //! Open the marker file, and optionally the tracing-enabled switch
+    bool open(const std::string& markerPath,
+              const std::string& enablePath) {
+      close();
+
+      const int fd = ::open(markerPath.c_str(),
+                            O_WRONLY | O_APPEND | O_CLOEXEC);
+      if (fd < 0) return false;
+
+      if (!enablePath.empty()) {
+        enableFd.store(::open(enablePath.c_str(), O_RDONLY | O_CLOEXEC));
+      }
+      markerFd.store(fd);
+      refresh();
+
+      return true;
+    }
+
+    //! Open the kernel's own trace_marker and tracing_on files
+    bool open() {
+      const std::string dir = tracingDir();
+      return open(dir + "trace_marker", dir + "tracing_on");
+    }
+
+    void close() {
+      enabled.store(false);
+      const int efd = enableFd.exchange(-1), mfd = markerFd.exchange(-1);
+      if (efd >= 0) ::close(efd);
+      if (mfd >= 0) ::close(mfd);
+    }
+
+    //! Re-read the tracing-enabled switch
+    void refresh() {
+      bool on = (markerFd.load(std::memory_order_relaxed) >= 0);
+      const int efd = enableFd.load(std::memory_order_relaxed);
+
+      if (on && efd >= 0) {
+        char flag = '0';
+        on = (pread(efd, &flag, 1, 0) == 1 && flag != '0');
+      }
+
+      enabled.store(on, std::memory_order_relaxed);
+    }
+
+    //! Check (cheaply) whether records should currently be written
+    bool isEnabled() {
+      static thread_local unsigned countdown = refreshInterval;
+      if (--countdown == 0) {
+        countdown = refreshInterval;
+        refresh();
+      }
+
+      return enabled.load(std::memory_order_relaxed);
+    }
+
+    //! Emit a preformatted record, as a single system call
+    void write(const std::string& record) {
+      const int fd = markerFd.load(std::memory_order_relaxed);
+      if (fd < 0) return;
+
+      if (::write(fd, record.data(), record.size()) < 0) {
+        enabled.store(false, std::memory_order_relaxed);
+      }
+    }
+
+  protected:
+    //! Number of queries between re-reading the tracing-enabled switch
+    static const unsigned refreshInterval = 4096;
+
+    std::atomic<int> markerFd;
+    std::atomic<int> enableFd;
+    std::atomic<bool> enabled;
+};
+
+
+/** Timer-statistics controller which also emits ftrace begin/end records
+ *
+ *  This wraps another manager (e.g. SerialManager), writing records
+ *  in the "B|pid|label" and "E|pid" form understood by trace-cmd,
+ *  perfetto and systrace, into TraceMarker::global().
+ *  Records are formatted once, when the timer is created,
+ *  and are skipped entirely while tracing is disabled.
+ *  Note that each record costs a system call, which will be included
+ *  within the measured intervals while tracing is active.
+ *
+ *  \see TraceMarker
+ */
+template <typename BASE>
+class TraceMarkerManager : public BASE
+{
+  public:
+    typedef typename BASE::Instant Instant;
+    typedef typename BASE::StatsAccumulator StatsAccumulator;
+
+    //! Prepare begin/end records for a given timer label
+    void setIdent(const std::string& ident) {
+      std::ostringstream pfx;
+      pfx << getpid();
+
+      beginRecord = "B|" + pfx.str() + "|" + ident;
+      endRecord = "E|" + pfx.str();
+    }
+
+    void recordStart(const Instant& now) {
+      TraceMarker& marker = TraceMarker::global();
+      if (marker.isEnabled()) marker.write(beginRecord);
+
+      BASE::recordStart(now);
+    }
+
+    double updateStats(const Instant& now, StatsAccumulator& stats) {
+      const double duration = BASE::updateStats(now, stats);
+
+      TraceMarker& marker = TraceMarker::global();
+      if (marker.isEnabled()) marker.write(endRecord);
+
+      return duration;
+    }
+
+  protected:
+    std::string beginRecord;
+    std::string endRecord;
+};
+
+template <typename BASE>
+void attachIdent(TraceMarkerManager<BASE>& mgr, const std::string& ident) {
+  mgr.setIdent(ident);
+}
+
+
+  }   // namespace ftrace
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_FTRACE_HPP */
@@ -0,0 +1,209 @@
+/*
+ *  Time-resolved latency heatmaps
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_HEATMAP_HPP
+#define _RTIMERS_HEATMAP_HPP
+
+#include <stdint.h>
+#include <vector>
+
+#include "core.hpp"
+
+
+namespace rtimers {
+
+
+/** Accumulate counts of time intervals by wall-time slice and latency bucket
+ *
+ *  Whole-run statistics can hide periodic spikes or shifts between
+ *  latency modes. This accumulator keeps a matrix of sample counts,
+ *  with one row per slice of elapsed time (one second by default),
+ *  and one column per logarithmic latency bucket, with PERDECADE buckets
+ *  per factor of ten above one nanosecond.
+ *
+ *  Samples are placed in time using the stop time already read
+ *  by the timer's manager, and rows are only appended when samples arrive.
+ *  If more than MAXSLICES rows would be needed, adjacent rows are merged
+ *  and the slice width doubled, so memory use remains bounded.
+ *  The matrix can be exported via writeCSV() or writeBinary().
+ *  \code
+ *  Timer<SerialManager<cxx11::HiResClock,
+ *                      HeatmapStats<cxx11::HiResClock> >,
+ *        NullLogger> tmr("request");
+ *  ...
+ *  std::ofstream csv("request.csv");
+ *  tmr.getStats().writeCSV(csv);
+ *  \endcode
+ *
+ *  \see BoundStats
+ */
+template <typename CLK, unsigned PERDECADE=4, unsigned BUCKETS=48,
+          unsigned MAXSLICES=1024>
+struct HeatmapStats : public BoundStats
+{
+  typedef typename CLK::Instant Instant;
+
+  HeatmapStats()
+    : sliceWidth(1.0), started(false) {}
+
+  //! Record a sample, reading the clock to find its time slice
+  void addSample(double dt) {
+    addSample(dt, CLK::now());
+  }
+
+  //! Record a sample which ended at a given time
+  void addSample(double dt, const Instant& when) {
+    BoundStats::addSample(dt);
+
+    if (!started) {
+      origin = when;
+      started = true;
+    }
+
+    const double elapsed = CLK::interval(origin, when);
+    size_t slice = (elapsed > 0.0 ? size_t(elapsed / sliceWidth) : 0);
+
+    while (slice >= MAXSLICES) {
+      coarsen();
+      slice /= 2;
+    }
+    if (slice >= counts.size() / BUCKETS) {
+      counts.resize((slice + 1) * BUCKETS, 0);
+    }
+
+    ++counts[slice * BUCKETS + bucketIndex(dt)];
+  }
+
+  /*! Choose the initial width of each time slice (in seconds)
+   *
+   *  This should be called before any samples are recorded.
+   */
+  void setSliceWidth(double width) {
+    sliceWidth = width;
+  }
+
+  double getSliceWidth() const {
+    return sliceWidth;
+  }
+
+  //! The number of time slices for which counts are held
+  size_t getSlices() const {
+    return counts.size() / BUCKETS;
+  }
+
+  //! The number of samples in a given time slice and latency bucket
+  unsigned long getCount(size_t slice, unsigned bucket) const {
+    return counts[slice * BUCKETS + bucket];
+  }
+
+  //! The lower edge of a latency bucket (in seconds)
+  static double bucketEdge(unsigned bucket) {
+    return minLatency() * std::pow(10.0, double(bucket) / PERDECADE);
+  }
+
+  //! Find the latency bucket into which a time interval falls
+  static unsigned bucketIndex(double dt) {
+    if (dt <= minLatency()) return 0;
+
+    const double pos = PERDECADE * std::log10(dt / minLatency());
+    return (pos < BUCKETS - 1 ? unsigned(pos) : BUCKETS - 1);
+  }
+
+  static double minLatency() {
+    return 1e-9;
+  }
+
+  /*! Write the matrix as comma-separated values
+   *
+   *  The first row holds the lower edge of each latency bucket (in seconds),
+   *  and each subsequent row holds the start of a time slice (in seconds
+   *  since the first sample) followed by the counts in each bucket.
+   */
+  void writeCSV(std::ostream& os) const {
+    os << "slice_start";
+    for (unsigned b=0; b<BUCKETS; ++b) os << "," << bucketEdge(b);
+    os << "\n";
+
+    for (size_t s=0; s<getSlices(); ++s) {
+      os << (s * sliceWidth);
+      for (unsigned b=0; b<BUCKETS; ++b) os << "," << getCount(s, b);
+      os << "\n";
+    }
+  }
+
+  /*! Write the matrix in a compact binary form
+   *
+   *  This consists of the four characters "RTHM", then native-endian
+   *  32-bit unsigned integers giving the number of slices, the number of
+   *  buckets and the buckets per decade, then 64-bit doubles giving
+   *  the slice width and the lower edge of the first bucket,
+   *  then 32-bit unsigned counts in row-major (slice-by-slice) order.
+   */
+  void writeBinary(std::ostream& os) const {
+    const uint32_t header[3] = {
+      uint32_t(getSlices()), uint32_t(BUCKETS), uint32_t(PERDECADE) };
+    const double scales[2] = { sliceWidth, minLatency() };
+
+    os.write("RTHM", 4);
+    os.write(reinterpret_cast<const char*>(header), sizeof(header));
+    os.write(reinterpret_cast<const char*>(scales), sizeof(scales));
+
+    for (size_t i=0; i<counts.size(); ++i) {
+      const uint32_t c = uint32_t(counts[i]);
+      os.write(reinterpret_cast<const char*>(&c), sizeof(c));
+    }
+  }
+
+  protected:
+    double sliceWidth;
+    bool started;
+    Instant origin;                     //!< Stop time of the first sample
+    std::vector<unsigned long> counts;  //!< Row-major matrix of counts
+
+    //! Halve the number of rows by merging adjacent time slices
+    void coarsen() {
+      const size_t slices = getSlices();
+
+      for (size_t s=0; s<slices; ++s) {
+        for (unsigned b=0; b<BUCKETS; ++b) {
+          const unsigned long c = counts[s * BUCKETS + b];
+          counts[s * BUCKETS + b] = 0;
+          counts[(s / 2) * BUCKETS + b] += c;
+        }
+      }
+
+      counts.resize(((slices + 1) / 2) * BUCKETS);
+      sliceWidth *= 2.0;
+    }
+};
+
+template <typename CLK, unsigned PERDECADE, unsigned BUCKETS,
+          unsigned MAXSLICES, typename INSTANT>
+void addTimedSample(HeatmapStats<CLK, PERDECADE, BUCKETS, MAXSLICES>& stats,
+                    double dt, const INSTANT& when) {
+  stats.addSample(dt, when);
+}
+
+template <typename CLK, unsigned PERDECADE, unsigned BUCKETS,
+          unsigned MAXSLICES>
+std::ostream& operator<<(std::ostream& os,
+                         const HeatmapStats<CLK, PERDECADE,
+                                            BUCKETS, MAXSLICES>& stats) {
+  const TimeUnit tu = BoundStats::guessUnit(stats.getSliceWidth());
+
+  os << static_cast<const BoundStats&>(stats)
+     << ", heatmap = " << stats.getSlices() << " slices of "
+     << (stats.getSliceWidth() * tu.mult) << tu.unit;
+  return os;
+}
+
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_HEATMAP_HPP */
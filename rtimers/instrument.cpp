@@ -0,0 +1,217 @@
+/*
+ *  Function entry/exit hooks for -finstrument-functions
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*  The hooks below are called on every entry and exit of instrumented
+ *  functions, so must avoid calling anything which might itself be
+ *  instrumented (including out-of-line copies of inline library functions).
+ *  They therefore use only plain arrays, compiler atomic builtins
+ *  and clock_gettime().
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <time.h>
+
+#include "instrument.hpp"
+#include "symbols.hpp"
+
+#define RTIMERS_NO_INSTRUMENT __attribute__((no_instrument_function))
+
+
+namespace rtimers {
+  namespace instrument {
+
+namespace {
+
+//! Aggregate timings of one function, in a lock-free open-addressed table
+struct Slot {
+  uintptr_t fn;
+  unsigned long long count;
+  unsigned long long inclusive;   // nanoseconds
+  unsigned long long exclusive;   // nanoseconds
+};
+
+//! Element of the per-thread shadow call-stack
+struct Frame {
+  uintptr_t fn;
+  unsigned long long start;       // nanoseconds
+  unsigned long long children;    // nanoseconds spent in callees
+};
+
+const unsigned tableBits = 14;
+const uintptr_t tableMask = (1u << tableBits) - 1;
+const unsigned maxDepth = 256;
+
+Slot table[1u << tableBits];
+unsigned long long dropped = 0;
+bool exitReport = true;
+
+thread_local Frame shadow[maxDepth];
+thread_local unsigned depth = 0;
+thread_local bool inHook = false;
+
+
+RTIMERS_NO_INSTRUMENT inline unsigned long long nowNs() {
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+
+
+//! Find or create the table entry for a function, or NULL if the table is full
+RTIMERS_NO_INSTRUMENT inline Slot* findSlot(uintptr_t fn) {
+  const uintptr_t idx = ((fn >> 4) * 0x9e3779b97f4a7c15ull) >> (64 - tableBits);
+
+  for (unsigned probe=0; probe<=tableMask; ++probe) {
+    Slot* slot = table + ((idx + probe) & tableMask);
+    uintptr_t key = __atomic_load_n(&slot->fn, __ATOMIC_ACQUIRE);
+
+    if (key == 0) {
+      if (__atomic_compare_exchange_n(&slot->fn, &key, fn, false,
+                                      __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return slot;
+      }
+    }
+    if (key == fn) return slot;
+  }
+
+  return NULL;
+}
+
+
+//! Emit function statistics as the program exits
+struct ExitReporter {
+  ~ExitReporter() {
+    if (exitReport) report<StderrLogger>();
+  }
+} exitReporter;
+
+}   // namespace (anonymous)
+
+
+std::ostream& operator<<(std::ostream& os, const FunctionStats& stats) {
+  const double mean = stats.inclusive / std::max(stats.count, 1ull);
+  const double meanExcl = stats.exclusive / std::max(stats.count, 1ull);
+  const TimeUnit tu = BoundStats::guessUnit(mean);
+
+  os << "<t> = " << (mean * tu.mult) << tu.unit << ", "
+     << "<t_self> = " << (meanExcl * tu.mult) << tu.unit << ", "
+     << "total = " << stats.inclusive << "s, "
+     << "self = " << stats.exclusive << "s"
+     << " (n=" << stats.count << ")";
+  return os;
+}
+
+
+std::vector<FunctionStats> collect() {
+  std::vector<FunctionStats> functions;
+
+  for (uintptr_t i=0; i<=tableMask; ++i) {
+    const Slot& slot = table[i];
+    const uintptr_t fn = __atomic_load_n(&slot.fn, __ATOMIC_ACQUIRE);
+    if (fn == 0) continue;
+
+    FunctionStats stats;
+    stats.address = reinterpret_cast<void*>(fn);
+    stats.name = symbolise(stats.address);
+    stats.count = __atomic_load_n(&slot.count, __ATOMIC_RELAXED);
+    stats.inclusive = 1e-9 * __atomic_load_n(&slot.inclusive, __ATOMIC_RELAXED);
+    stats.exclusive = 1e-9 * __atomic_load_n(&slot.exclusive, __ATOMIC_RELAXED);
+    functions.push_back(stats);
+  }
+
+  std::sort(functions.begin(), functions.end(),
+            [](const FunctionStats& a, const FunctionStats& b) {
+              return a.exclusive > b.exclusive; });
+
+  return functions;
+}
+
+
+void reset() {
+  for (uintptr_t i=0; i<=tableMask; ++i) {
+    Slot& slot = table[i];
+    __atomic_store_n(&slot.count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot.inclusive, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot.exclusive, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot.fn, 0, __ATOMIC_RELEASE);
+  }
+  __atomic_store_n(&dropped, 0, __ATOMIC_RELAXED);
+}
+
+
+void setExitReport(bool enable) {
+  exitReport = enable;
+}
+
+
+unsigned long long droppedCalls() {
+  return __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+}
+
+
+  }   // namespace instrument
+}   // namespace rtimers
+
+
+using namespace rtimers::instrument;
+
+extern "C" {
+
+RTIMERS_NO_INSTRUMENT
+void __cyg_profile_func_enter(void* fn, void* callsite) {
+  if (inHook) return;
+  inHook = true;
+
+  if (depth < maxDepth) {
+    Frame& frame = shadow[depth];
+    frame.fn = reinterpret_cast<uintptr_t>(fn);
+    frame.children = 0;
+    frame.start = nowNs();
+  } else {
+    __atomic_add_fetch(&dropped, 1, __ATOMIC_RELAXED);
+  }
+  ++depth;
+
+  inHook = false;
+}
+
+
+RTIMERS_NO_INSTRUMENT
+void __cyg_profile_func_exit(void* fn, void* callsite) {
+  if (inHook || depth == 0) return;
+  inHook = true;
+
+  const unsigned long long stop = nowNs();
+  --depth;
+
+  if (depth < maxDepth) {
+    const Frame& frame = shadow[depth];
+    const unsigned long long elapsed = stop - frame.start;
+
+    if (depth > 0) shadow[depth - 1].children += elapsed;
+
+    Slot* slot = findSlot(frame.fn);
+    if (slot) {
+      __atomic_add_fetch(&slot->count, 1, __ATOMIC_RELAXED);
+      __atomic_add_fetch(&slot->inclusive, elapsed, __ATOMIC_RELAXED);
+      __atomic_add_fetch(&slot->exclusive, elapsed - frame.children,
+                         __ATOMIC_RELAXED);
+    } else {
+      __atomic_add_fetch(&dropped, 1, __ATOMIC_RELAXED);
+    }
+  }
+
+  inHook = false;
+}
+
+}   // extern "C"
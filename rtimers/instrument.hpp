@@ -0,0 +1,83 @@
+/*
+ *  Automatic per-function timing via -finstrument-functions
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*  Unlike the rest of rtimers, this facility requires the accompanying
+ *  translation unit (rtimers/instrument.cpp) to be linked into the
+ *  application, which provides the __cyg_profile_func_enter() and
+ *  __cyg_profile_func_exit() hooks called by code compiled with
+ *  -finstrument-functions. That translation unit must not itself
+ *  be compiled with -finstrument-functions. Function names are only
+ *  looked up (via dladdr) when reports are generated, so executables
+ *  should be linked with -rdynamic for meaningful names.
+ */
+
+#ifndef _RTIMERS_INSTRUMENT_HPP
+#define _RTIMERS_INSTRUMENT_HPP
+
+#if __cplusplus < 201100
+#  error "rtimers/instrument requires C++11 support"
+#endif
+
+#include <string>
+#include <vector>
+
+#include "core.hpp"
+
+
+namespace rtimers {
+  namespace instrument {
+
+
+/** Time spent within a single instrumented function
+ *
+ *  Inclusive time covers the whole interval between entry and exit,
+ *  while exclusive time omits intervals spent in instrumented callees.
+ *  Recursive functions will have their inclusive time counted
+ *  once for each level of recursion.
+ */
+struct FunctionStats
+{
+  void* address;              //!< Entry-point of the function
+  std::string name;           //!< Demangled symbol name, if available
+  unsigned long long count;   //!< Number of calls
+  double inclusive;           //!< Total inclusive time (seconds)
+  double exclusive;           //!< Total exclusive time (seconds)
+};
+
+std::ostream& operator<<(std::ostream& os, const FunctionStats& stats);
+
+
+//! Symbolise and gather all function statistics, by decreasing exclusive time
+std::vector<FunctionStats> collect();
+
+//! Report statistics of all instrumented functions via a timer logger
+template <typename LOG=StderrLogger>
+void report() {
+  const std::vector<FunctionStats> functions = collect();
+
+  for (size_t i=0; i<functions.size(); ++i) {
+    LOG::report(functions[i].name, functions[i]);
+  }
+}
+
+//! Discard all accumulated statistics (not safe while instrumented code runs)
+void reset();
+
+//! Disable or re-enable the automatic report on program exit
+void setExitReport(bool enable);
+
+//! Number of calls ignored because of stack depth or table capacity
+unsigned long long droppedCalls();
+
+
+  }   // namespace instrument
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_INSTRUMENT_HPP */
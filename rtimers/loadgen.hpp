@@ -0,0 +1,246 @@
+/*
+ *  Open-loop load generation at constant or Poisson arrival rates
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_LOADGEN_HPP
+#define _RTIMERS_LOADGEN_HPP
+
+#if __cplusplus < 201100
+#  error "rtimers/loadgen requires C++11 support"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "core.hpp"
+
+
+namespace rtimers {
+
+
+/** Latency statistics measured at a single offered request rate
+ *
+ *  Latency is measured from the time at which each request was scheduled
+ *  to start, so includes any time spent waiting for a free worker,
+ *  whereas service time is measured from when the request actually started.
+ */
+struct LoadPoint
+{
+  LoadPoint()
+    : rate(0.0), throughput(0.0), issued(0),
+      p50(0.0), p90(0.0), p99(0.0), p999(0.0) {}
+
+  double rate;              //!< Offered request rate (per second)
+  double throughput;        //!< Achieved completion rate (per second)
+  unsigned long issued;     //!< Number of requests made
+  VarBoundStats latency;    //!< Time from scheduled start to completion
+  VarBoundStats service;    //!< Time from actual start to completion
+  double p50, p90, p99, p999;   //!< Percentiles of latency
+};
+
+inline std::ostream& operator<<(std::ostream& os, const LoadPoint& point) {
+  const TimeUnit tu = BoundStats::guessUnit(point.p50);
+
+  os << "rate = " << point.rate << "/s, throughput = " << point.throughput
+     << "/s, latency p50/p90/p99/p99.9 = "
+     << (point.p50 * tu.mult) << "/" << (point.p90 * tu.mult) << "/"
+     << (point.p99 * tu.mult) << "/" << (point.p999 * tu.mult) << tu.unit
+     << "; latency: " << point.latency
+     << "; service: " << point.service;
+  return os;
+}
+
+//! Write a latency-vs-throughput curve as comma-separated values
+inline void writeLoadCurve(std::ostream& os,
+                           const std::vector<LoadPoint>& curve) {
+  os << "rate,throughput,mean,p50,p90,p99,p99.9,max,service_mean\n";
+
+  for (size_t i=0; i<curve.size(); ++i) {
+    const LoadPoint& pt = curve[i];
+    os << pt.rate << "," << pt.throughput << "," << pt.latency.mean << ","
+       << pt.p50 << "," << pt.p90 << "," << pt.p99 << "," << pt.p999 << ","
+       << pt.latency.tmax << "," << pt.service.mean << "\n";
+  }
+}
+
+
+/** Harness for issuing requests on an open-loop schedule
+ *
+ *  Closed-loop benchmarks, which start each request when the previous one
+ *  completes, slow down along with the system under test, and so hide
+ *  queueing delay. This harness instead draws up a schedule of
+ *  request start times, at either a constant rate or with exponentially
+ *  distributed gaps (Poisson arrivals), which a pool of worker threads
+ *  then follows regardless of how long each request takes.
+ *  \code
+ *  LoadGenerator gen(4, LoadGenerator::POISSON);
+ *  const std::vector<LoadPoint> curve =
+ *    gen.sweep([]() { handleRequest(); }, 1000, 20000, 8, 2.0);
+ *  writeLoadCurve(std::cout, curve);
+ *  \endcode
+ *
+ *  \see LoadPoint, OmissionCorrectedStats
+ */
+class LoadGenerator
+{
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+    enum Arrivals { CONSTANT, POISSON };
+
+    LoadGenerator(unsigned threads=1, Arrivals arr=CONSTANT,
+                  unsigned seed=5489u)
+      : workers(std::max(threads, 1u)), arrivals(arr), rng(seed) {}
+
+    /*! Draw up request start times (in seconds) for a given rate and duration
+     *
+     *  \return An empty schedule if the rate or duration is not
+     *           positive and finite
+     */
+    std::vector<double> schedule(double rate, double duration) {
+      std::vector<double> starts;
+      if (!isValid(rate, duration)) return starts;
+
+      std::exponential_distribution<double> gaps(rate);
+      double t = 0.0;
+
+      for (unsigned long i=0; ; ++i) {
+        t = (arrivals == POISSON ? t + gaps(rng) : i / rate);
+        if (t >= duration) break;
+        starts.push_back(t);
+      }
+
+      return starts;
+    }
+
+    /*! Issue requests at a given rate (per second) for a given time
+     *
+     *  \return An empty LoadPoint if the rate or duration is invalid
+     */
+    template <typename FN>
+    LoadPoint run(FN fn, double rate, double duration) {
+      if (!isValid(rate, duration)) return LoadPoint();
+
+      const std::vector<double> starts = schedule(rate, duration);
+      std::vector<std::vector<Sample> > samples(workers);
+      std::atomic<size_t> next(0);
+      const Clock::time_point t0 = Clock::now();
+
+      std::vector<std::thread> pool;
+      for (unsigned w=0; w<workers; ++w) {
+        pool.push_back(std::thread([&, w]() {
+          std::vector<Sample>& mine = samples[w];
+          for (;;) {
+            const size_t idx = next.fetch_add(1);
+            if (idx >= starts.size()) break;
+
+            const Clock::time_point due = t0 +
+                std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(starts[idx]));
+            std::this_thread::sleep_until(due);
+
+            const Clock::time_point begin = Clock::now();
+            fn();
+            const Clock::time_point end = Clock::now();
+
+            mine.push_back(Sample{ seconds(end - due),
+                                   seconds(end - begin) });
+          }
+        }));
+      }
+      for (auto& thr : pool) thr.join();
+
+      const double elapsed = std::max(seconds(Clock::now() - t0), duration);
+      return summarize(samples, rate, elapsed);
+    }
+
+    /*! Measure latency at a sequence of geometrically spaced rates
+     *
+     *  \return One LoadPoint for each of 'steps' rates, from minRate
+     *  to maxRate inclusive, each being run for the given duration,
+     *  or an empty curve if either rate or the duration is invalid
+     */
+    template <typename FN>
+    std::vector<LoadPoint> sweep(FN fn, double minRate, double maxRate,
+                                 unsigned steps, double duration) {
+      std::vector<LoadPoint> curve;
+      if (!isValid(minRate, duration) || !isValid(maxRate, duration)) {
+        return curve;
+      }
+      const double ratio = (steps > 1
+                              ? std::pow(maxRate / minRate, 1.0 / (steps - 1))
+                              : 1.0);
+
+      for (unsigned s=0; s<steps; ++s) {
+        curve.push_back(run(fn, minRate * std::pow(ratio, double(s)),
+                            duration));
+      }
+
+      return curve;
+    }
+
+  protected:
+    struct Sample {
+      double latency;
+      double service;
+    };
+
+    const unsigned workers;
+    const Arrivals arrivals;
+    std::mt19937 rng;
+
+    static bool isValid(double rate, double duration) {
+      return (rate > 0.0 && std::isfinite(rate)
+              && duration > 0.0 && std::isfinite(duration));
+    }
+
+    static double seconds(Clock::duration dt) {
+      return std::chrono::duration<double>(dt).count();
+    }
+
+    static double percentile(const std::vector<double>& sorted, double p) {
+      if (sorted.empty()) return 0.0;
+      const size_t rank = size_t(std::ceil(p * sorted.size()));
+      return sorted[std::min(std::max(rank, size_t(1)), sorted.size()) - 1];
+    }
+
+    static LoadPoint summarize(const std::vector<std::vector<Sample> >& samples,
+                               double rate, double elapsed) {
+      LoadPoint point;
+      std::vector<double> latencies;
+
+      for (auto& mine : samples) {
+        for (auto& smp : mine) {
+          point.latency.addSample(smp.latency);
+          point.service.addSample(smp.service);
+          latencies.push_back(smp.latency);
+        }
+      }
+      std::sort(latencies.begin(), latencies.end());
+
+      point.rate = rate;
+      point.issued = latencies.size();
+      point.throughput = latencies.size() / elapsed;
+      point.p50 = percentile(latencies, 0.5);
+      point.p90 = percentile(latencies, 0.9);
+      point.p99 = percentile(latencies, 0.99);
+      point.p999 = percentile(latencies, 0.999);
+
+      return point;
+    }
+};
+
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_LOADGEN_HPP */
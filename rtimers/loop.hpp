@@ -0,0 +1,195 @@
+/*
+ *  Jitter and deadline statistics for periodic loops
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_LOOP_HPP
+#define _RTIMERS_LOOP_HPP
+
+#include "core.hpp"
+
+
+namespace rtimers {
+
+
+/** Accumulate period, busy-time and lateness statistics of a periodic loop
+ *
+ *  Each iteration's lateness is the amount by which its tick-to-tick
+ *  interval exceeded the nominal period. Iterations later than
+ *  the configured slack are counted as deadline misses,
+ *  and all iterations are binned into a histogram of lateness
+ *  measured as a fraction of the nominal period.
+ *
+ *  \see LoopTimer
+ */
+template <typename STATS=VarBoundStats>
+struct LoopStats
+{
+  enum { NBINS = 7 };
+
+  LoopStats(double nominal, double slk)
+    : period(nominal), slack(slk), misses(0) {
+    for (unsigned i=0; i<NBINS; ++i) lateness[i] = 0;
+  }
+
+  //! Record the interval between the starts of adjacent iterations
+  void addPeriod(double dt) {
+    periods.addSample(dt);
+
+    const double late = dt - period;
+    if (late > slack) ++misses;
+    ++lateness[binIndex(late / period)];
+  }
+
+  //! Record the time spent working within a single iteration
+  void addBusy(double dt) {
+    busy.addSample(dt);
+  }
+
+  //! Upper edge of a histogram bin, as a fraction of the nominal period
+  static double binEdge(unsigned idx) {
+    static const double edges[NBINS - 1] = {
+      0.01, 0.03, 0.1, 0.3, 1.0, 3.0 };
+    return edges[idx];
+  }
+
+  //! Find the histogram bin for a lateness expressed in periods
+  static unsigned binIndex(double fraction) {
+    unsigned idx = 0;
+    while (idx < (NBINS - 1) && fraction >= binEdge(idx)) ++idx;
+    return idx;
+  }
+
+  double period;        //!< Nominal loop period (seconds)
+  double slack;         //!< Lateness tolerated before counting a miss
+  STATS periods;        //!< Tick-to-tick intervals
+  STATS busy;           //!< Time from tick to idle within each iteration
+  unsigned long misses; //!< Number of iterations later than the slack
+  unsigned long lateness[NBINS];  //!< Histogram of lateness/period
+};
+
+template <typename STATS>
+std::ostream& operator<<(std::ostream& os, const LoopStats<STATS>& stats) {
+  const TimeUnit tu = BoundStats::guessUnit(stats.period);
+
+  os << "period: " << stats.periods << "; "
+     << "busy: " << stats.busy << "; "
+     << "misses = " << stats.misses
+     << " (T = " << (stats.period * tu.mult) << tu.unit
+     << ", slack = " << (stats.slack * tu.mult) << tu.unit << "); "
+     << "lateness/T:";
+
+  for (unsigned i=0; i<LoopStats<STATS>::NBINS; ++i) {
+    if (i < (LoopStats<STATS>::NBINS - 1)) {
+      os << " <" << (100 * LoopStats<STATS>::binEdge(i)) << "%";
+    } else {
+      os << " >=" << (100 * LoopStats<STATS>::binEdge(i - 1)) << "%";
+    }
+    os << ":" << stats.lateness[i];
+  }
+  return os;
+}
+
+
+/** Gather jitter and deadline-miss statistics from a periodic loop
+ *
+ *  The loop should call tick() once at the start of each iteration,
+ *  which takes a single reading of the clock and returns it so that
+ *  the loop can reuse that reading for its own scheduling.
+ *  Optionally, idle() can be called when the iteration's work is complete,
+ *  to gather busy-time statistics, with its clock reading
+ *  likewise being returned for computing the following sleep.
+ *  \code
+ *  LoopTimer<cxx11::HiResClock> timer("control", 1e-3);
+ *  for (;;) {
+ *    const auto now = timer.tick();
+ *    // Do control work...
+ *    timer.idle();
+ *    std::this_thread::sleep_until(now + std::chrono::milliseconds(1));
+ *  }
+ *  \endcode
+ *
+ *  \see LoopStats, Timer
+ */
+template <typename CLK, typename STATS=VarBoundStats, typename LOG=StderrLogger>
+class LoopTimer
+{
+  public:
+    typedef typename CLK::Instant Instant;
+    typedef LoopStats<STATS> Stats;
+
+    /*! Create a timer for a loop with a given nominal period (in seconds)
+     *
+     *  Iterations whose period exceeds the nominal value by more
+     *  than the slack count as deadline misses. A negative slack
+     *  selects a default of 5% of the nominal period.
+     */
+    LoopTimer(const std::string& name, double period, double slack=-1.0)
+      : ident(name), stats(period, (slack >= 0.0 ? slack : 0.05 * period)),
+        running(false) {}
+    ~LoopTimer() {
+      LOG::report(ident, stats);
+    }
+
+    //! Mark the start of an iteration, returning the current time
+    Instant tick() {
+      const Instant now = CLK::now();
+      tick(now);
+      return now;
+    }
+
+    //! Mark the start of an iteration using an existing clock reading
+    void tick(const Instant& now) {
+      if (running) {
+        stats.addPeriod(CLK::interval(lastTick, now));
+      }
+      lastTick = now;
+      running = true;
+    }
+
+    //! Mark the end of an iteration's work, returning the current time
+    Instant idle() {
+      const Instant now = CLK::now();
+      idle(now);
+      return now;
+    }
+
+    //! Mark the end of an iteration's work using an existing clock reading
+    void idle(const Instant& now) {
+      if (running) {
+        stats.addBusy(CLK::interval(lastTick, now));
+      }
+    }
+
+    //! Forget the previous tick, e.g. after the loop has been paused
+    void restart() {
+      running = false;
+    }
+
+    //! Get current loop statistics (not thread safe)
+    const Stats& getStats() const {
+      return stats;
+    }
+
+  protected:
+    //! An identifying label for this timer instance
+    const std::string ident;
+
+    //! Accumulated period, busy-time and lateness statistics
+    Stats stats;
+
+    //! Time at which the current iteration started
+    Instant lastTick;
+
+    //! Whether lastTick holds a valid reading
+    bool running;
+};
+
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_LOOP_HPP */
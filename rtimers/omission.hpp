@@ -0,0 +1,115 @@
+/*
+ *  Coordinated-omission correction for fixed-rate measurement loops
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_OMISSION_HPP
+#define _RTIMERS_OMISSION_HPP
+
+#include <algorithm>
+
+#include "core.hpp"
+
+
+namespace rtimers {
+
+
+/** Accumulate raw and coordinated-omission-corrected statistics
+ *
+ *  A load-testing loop which issues requests at a fixed interval,
+ *  but waits for each to complete, will issue no requests while
+ *  a slow one is outstanding, so recording just one slow sample
+ *  where many requests would have been delayed.
+ *  Given the expected interval between requests, this accumulator
+ *  follows HdrHistogram in back-filling the samples which would have
+ *  been seen by requests issued during each stall, i.e. intervals of
+ *  dt - T, dt - 2T, ... down to T.
+ *  So that a long stall (or a mis-configured interval) cannot flood
+ *  the timed thread with synthetic samples, at most a limited number
+ *  are back-filled for each measured sample, spread evenly across
+ *  that range, and the remainder are counted as truncated.
+ *  Both raw and corrected statistics are kept.
+ *  \code
+ *  Timer<SerialManager<cxx11::HiResClock,
+ *                      OmissionCorrectedStats<> >,
+ *        StderrLogger> tmr("request");
+ *  tmr.getStats().setInterval(1e-3);
+ *  \endcode
+ *
+ *  \see LoopTimer
+ */
+template <typename STATS=VarBoundStats>
+struct OmissionCorrectedStats
+{
+  enum { DEFAULT_BACKFILL_LIMIT = 1024 };
+
+  OmissionCorrectedStats(double expected=0.0)
+    : interval(expected), backfillLimit(DEFAULT_BACKFILL_LIMIT),
+      backfilled(0), truncated(0) {}
+
+  //! Set the expected interval between requests (zero disables correction)
+  void setInterval(double expected) {
+    interval = expected;
+  }
+
+  double getInterval() const {
+    return interval;
+  }
+
+  //! Set the largest number of synthetic samples added for one sample
+  void setBackfillLimit(unsigned long limit) {
+    backfillLimit = limit;
+  }
+
+  void addSample(double dt) {
+    raw.addSample(dt);
+    corrected.addSample(dt);
+
+    if (interval <= 0.0 || dt < 2.0 * interval) return;
+
+    // Allow for rounding in dt, so that exact multiples back-fill fully,
+    // and clamp the count, so that it cannot overflow:
+    const double ratio = std::min(dt / interval + 1e-9, 1e18);
+    const unsigned long missing = (unsigned long)ratio - 1;
+    const unsigned long added = std::min(missing, backfillLimit);
+
+    for (unsigned long j=1; j<=added; ++j) {
+      // Spread the samples evenly, when some must be skipped:
+      const unsigned long k = (added < missing
+                                ? (unsigned long)(double(j) * missing / added)
+                                : j);
+      corrected.addSample(dt - k * interval);
+    }
+    backfilled += added;
+    truncated += missing - added;
+  }
+
+  STATS raw;                  //!< Samples as measured
+  STATS corrected;            //!< Measured and back-filled samples
+  double interval;            //!< Expected interval between requests
+  unsigned long backfillLimit;  //!< Most synthetic samples per sample
+  unsigned long backfilled;   //!< Number of synthetic samples added
+  unsigned long truncated;    //!< Synthetic samples skipped by the limit
+};
+
+template <typename STATS>
+std::ostream& operator<<(std::ostream& os,
+                         const OmissionCorrectedStats<STATS>& stats) {
+  const TimeUnit tu = BoundStats::guessUnit(stats.interval);
+
+  os << "raw: " << stats.raw << "; "
+     << "corrected: " << stats.corrected
+     << " (backfilled = " << stats.backfilled;
+  if (stats.truncated > 0) os << ", truncated = " << stats.truncated;
+  os << ", T = " << (stats.interval * tu.mult) << tu.unit << ")";
+  return os;
+}
+
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_OMISSION_HPP */
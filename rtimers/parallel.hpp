@@ -0,0 +1,191 @@
+/*
+ *  Load-imbalance statistics for fork/join parallel regions
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_PARALLEL_HPP
+#define _RTIMERS_PARALLEL_HPP
+
+#if __cplusplus < 201100
+#  error "rtimers/parallel requires C++11 support"
+#endif
+
+#include <mutex>
+
+#include "core.hpp"
+
+
+namespace rtimers {
+
+
+/** Accumulate per-instance load-balance statistics of a parallel region
+ *
+ *  For each instance of the region, the times spent by each thread
+ *  are summarized by their maximum, minimum and mean. The imbalance ratio
+ *  is the maximum divided by the mean (one for perfect balance),
+ *  and the wasted time is the total thread-time spent waiting at the join
+ *  for the last thread to finish.
+ *
+ *  \see ParallelRegionTimer
+ */
+template <typename STATS=VarBoundStats>
+struct RegionStats
+{
+  RegionStats()
+    : instances(0) {}
+
+  void addInstance(double tmax, double tmin, double tmean,
+                   double waste) {
+    ++instances;
+    maxTime.addSample(tmax);
+    minTime.addSample(tmin);
+    meanTime.addSample(tmean);
+    imbalance.addSample(tmean > 0.0 ? tmax / tmean : 1.0);
+    wasted.addSample(waste);
+  }
+
+  unsigned long instances;
+  STATS maxTime;        //!< Time of the slowest thread in each instance
+  STATS minTime;        //!< Time of the fastest thread in each instance
+  STATS meanTime;       //!< Mean thread time in each instance
+  VarBoundStats imbalance;  //!< Ratio of slowest to mean thread time
+  STATS wasted;         //!< Thread-time spent waiting at each join
+};
+
+template <typename STATS>
+std::ostream& operator<<(std::ostream& os, const RegionStats<STATS>& stats) {
+  os << "max: " << stats.maxTime << "; "
+     << "min: " << stats.minTime << "; "
+     << "mean: " << stats.meanTime << "; "
+     << "wasted: " << stats.wasted << "; "
+     << "imbalance = " << stats.imbalance.mean
+     << " (worst " << stats.imbalance.tmax << ")";
+  return os;
+}
+
+
+/** Timer for regions of code executed concurrently by a team of threads
+ *
+ *  Each participating thread calls enter() when it starts its share of
+ *  the work, and leave() when it has finished. Once all participants
+ *  have left, the instance is summarized and added to the statistics,
+ *  so that stragglers are not hidden by aggregating per-thread times.
+ *  \code
+ *  ParallelRegionTimer<cxx11::HiResClock> tmr("stencil", nThreads);
+ *  #pragma omp parallel num_threads(nThreads)
+ *  {
+ *    auto scope = tmr.scopedEnter();
+ *    // Do share of work...
+ *  }
+ *  \endcode
+ *
+ *  \see RegionStats
+ */
+template <typename CLK, typename STATS=VarBoundStats, typename LOG=StderrLogger>
+class ParallelRegionTimer
+{
+  public:
+    typedef typename CLK::Instant Instant;
+    typedef RegionStats<STATS> Stats;
+
+    //! Mechanism for automatically leaving the region at the end of a scope
+    class Scoper
+    {
+      public:
+        Scoper(ParallelRegionTimer& tmr)
+          : timer(tmr), entered(tmr.enter()) {}
+        ~Scoper() {
+          timer.leave(entered);
+        }
+
+      protected:
+        ParallelRegionTimer& timer;
+        const Instant entered;
+    };
+
+    ParallelRegionTimer(const std::string& name, unsigned threads)
+      : ident(name), participants(threads) {
+      resetInstance();
+    }
+    ~ParallelRegionTimer() {
+      LOG::report(ident, stats);
+    }
+
+    //! Change the number of threads taking part in future instances
+    void setParticipants(unsigned threads) {
+      std::lock_guard<std::mutex> lock(mtx);
+      participants = threads;
+    }
+
+    //! Note that the calling thread has started work, returning the time
+    Instant enter() {
+      const Instant now = CLK::now();
+      std::lock_guard<std::mutex> lock(mtx);
+
+      if (entered == 0) origin = now;
+      ++entered;
+      return now;
+    }
+
+    //! Note that the calling thread, which entered at a given time, is done
+    void leave(const Instant& start) {
+      const Instant now = CLK::now();
+      std::lock_guard<std::mutex> lock(mtx);
+
+      const double dt = CLK::interval(start, now);
+      const double finish = CLK::interval(origin, now);
+
+      ++left;
+      sumTime += dt;
+      sumFinish += finish;
+      if (dt > maxTime) maxTime = dt;
+      if (dt < minTime) minTime = dt;
+      if (finish > lastFinish) lastFinish = finish;
+
+      if (left >= participants) {
+        stats.addInstance(maxTime, minTime, sumTime / left,
+                          left * lastFinish - sumFinish);
+        resetInstance();
+      }
+    }
+
+    //! Create object which will enter now, and leave when out of scope
+    Scoper scopedEnter() {
+      return Scoper(*this);
+    }
+
+    //! Get statistics of completed instances (not thread safe)
+    const Stats& getStats() const {
+      return stats;
+    }
+
+  protected:
+    //! An identifying label for this timer instance
+    const std::string ident;
+
+    unsigned participants;
+    Stats stats;
+    std::mutex mtx;
+
+    // Properties of the region instance currently in progress:
+    Instant origin;         //!< Time at which the first thread entered
+    unsigned entered, left;
+    double sumTime, maxTime, minTime;
+    double sumFinish, lastFinish;   //!< Finishing times relative to origin
+
+    void resetInstance() {
+      entered = left = 0;
+      sumTime = sumFinish = lastFinish = 0.0;
+      maxTime = -1e18;
+      minTime = 1e18;
+    }
+};
+
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_PARALLEL_HPP */
@@ -0,0 +1,654 @@
+/*
+ *  Entry/exit trampolines for run-time patched function timing
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*  A patched sled contains "call rtimers_patch_entry_tramp", which saves
+ *  the argument registers and calls rtimers_patch_enter(). That records
+ *  the entry time on a per-thread shadow stack, and replaces the caller's
+ *  return address with rtimers_patch_exit_tramp, so that when the patched
+ *  function returns, rtimers_patch_exit() can accumulate its duration
+ *  and hand back the original return address.
+ *
+ *  Sleds are rewritten via a temporary breakpoint on their first byte,
+ *  as described for writeSled(), so that concurrently executing threads
+ *  never see a partially rewritten sled. Doing so relies on handlers
+ *  for SIGTRAP and for the scrubbing signal (SIGRTMAX-3 by default),
+ *  which are installed on first patching.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <map>
+#include <mutex>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#if defined(__linux__)
+#  include <linux/membarrier.h>
+#endif
+
+#include "patch.hpp"
+#include "registry.hpp"
+#include "symbols.hpp"
+
+#if defined(__x86_64__) && defined(__linux__)
+#  define RTIMERS_PATCH_SUPPORTED 1
+#else
+#  define RTIMERS_PATCH_SUPPORTED 0
+#endif
+
+
+namespace rtimers {
+  namespace patch {
+
+namespace {
+
+const size_t sledSize = 5;
+const unsigned char breakpoint = 0xcc;       // int3
+const unsigned long long scrubTimeoutNs = 1000000000ull;
+const unsigned maxDepth = 256;
+const unsigned tableBits = 10;
+const uintptr_t tableMask = (1u << tableBits) - 1;
+
+
+//! Book-keeping for a function which has been patched at least once
+struct Entry {
+  uintptr_t sled;
+  unsigned char original[sledSize];    // Unpatched contents of sled
+  PatchedStats info;
+  RegistryEntry* timer;                // Registered timer of the same name
+  std::mutex mtx;
+
+  void addSample(double dt) {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      info.stats.addSample(dt);
+    }
+    timer->addSample(dt);
+  }
+};
+
+//! Element of the per-thread stack of patched functions in progress
+struct Frame {
+  Entry* entry;
+  uintptr_t returnAddr;
+  unsigned long long start;
+};
+
+//! Lock-free lookup from sled address to entry (entries are never removed)
+uintptr_t sledKeys[1u << tableBits];
+Entry* sledEntries[1u << tableBits];
+
+std::mutex patchMtx;
+std::map<std::string, Entry*> entries;
+
+thread_local Frame shadow[maxDepth];
+thread_local unsigned depth = 0;
+
+
+inline unsigned long long nowNs() {
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+
+inline uintptr_t sledHash(uintptr_t sled) {
+  return ((sled >> 4) * 0x9e3779b97f4a7c15ull) >> (64 - tableBits);
+}
+
+Entry* findEntry(uintptr_t sled) {
+  const uintptr_t idx = sledHash(sled);
+
+  for (uintptr_t probe=0; probe<=tableMask; ++probe) {
+    const uintptr_t pos = (idx + probe) & tableMask;
+    const uintptr_t key = __atomic_load_n(&sledKeys[pos], __ATOMIC_ACQUIRE);
+    if (key == sled) return sledEntries[pos];
+    if (key == 0) break;
+  }
+
+  return NULL;
+}
+
+//! Add an entry to the lookup table (called with patchMtx held)
+bool insertEntry(Entry* entry) {
+  const uintptr_t idx = sledHash(entry->sled);
+
+  for (uintptr_t probe=0; probe<=tableMask; ++probe) {
+    const uintptr_t pos = (idx + probe) & tableMask;
+    if (sledKeys[pos] == 0) {
+      sledEntries[pos] = entry;
+      __atomic_store_n(&sledKeys[pos], entry->sled, __ATOMIC_RELEASE);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+//! Check whether a symbol matches a mangled or (partial) demangled name
+bool nameMatches(const char* symbol, const std::string& name) {
+  if (name == symbol) return true;
+
+  const std::string full = demangle(symbol);
+  if (name == full) return true;
+
+  const size_t paren = full.find('(');
+  return (paren != std::string::npos && name == full.substr(0, paren));
+}
+
+}   // namespace (anonymous)
+
+  }   // namespace patch
+}   // namespace rtimers
+
+
+extern "C" {
+
+// Boundaries of the table of sled addresses, provided by the linker:
+extern const uintptr_t __start___patchable_function_entries[]
+    __attribute__((weak, visibility("hidden")));
+extern const uintptr_t __stop___patchable_function_entries[]
+    __attribute__((weak, visibility("hidden")));
+
+void rtimers_patch_entry_tramp();
+void rtimers_patch_exit_tramp();
+
+
+__attribute__((visibility("hidden"), used))
+void rtimers_patch_enter(uintptr_t resume, uintptr_t* retSlot) {
+  using namespace rtimers::patch;
+
+  if (depth >= maxDepth) return;
+
+  Entry* entry = findEntry(resume - sledSize);
+  if (!entry) return;
+
+  Frame& frame = shadow[depth++];
+  frame.entry = entry;
+  frame.returnAddr = *retSlot;
+  *retSlot = reinterpret_cast<uintptr_t>(&rtimers_patch_exit_tramp);
+  frame.start = nowNs();
+}
+
+
+__attribute__((visibility("hidden"), used))
+uintptr_t rtimers_patch_exit() {
+  using namespace rtimers::patch;
+
+  const unsigned long long stop = nowNs();
+  const Frame& frame = shadow[--depth];
+
+  frame.entry->addSample(1e-9 * (stop - frame.start));
+
+  return frame.returnAddr;
+}
+
+}   // extern "C"
+
+
+#if RTIMERS_PATCH_SUPPORTED
+// All caller-saved registers are preserved, because callers may
+// (e.g. via -fipa-ra) rely on the unpatched function leaving some intact.
+__asm__(
+  ".text\n"
+  ".p2align 4\n"
+  ".globl rtimers_patch_entry_tramp\n"
+  ".hidden rtimers_patch_entry_tramp\n"
+  ".type rtimers_patch_entry_tramp, @function\n"
+  "rtimers_patch_entry_tramp:\n"
+  "  pushq %rax\n"
+  "  pushq %rcx\n"
+  "  pushq %rdx\n"
+  "  pushq %rsi\n"
+  "  pushq %rdi\n"
+  "  pushq %r8\n"
+  "  pushq %r9\n"
+  "  pushq %r10\n"
+  "  pushq %r11\n"
+  "  subq $264, %rsp\n"
+  "  movdqu %xmm0, 0(%rsp)\n"
+  "  movdqu %xmm1, 16(%rsp)\n"
+  "  movdqu %xmm2, 32(%rsp)\n"
+  "  movdqu %xmm3, 48(%rsp)\n"
+  "  movdqu %xmm4, 64(%rsp)\n"
+  "  movdqu %xmm5, 80(%rsp)\n"
+  "  movdqu %xmm6, 96(%rsp)\n"
+  "  movdqu %xmm7, 112(%rsp)\n"
+  "  movdqu %xmm8, 128(%rsp)\n"
+  "  movdqu %xmm9, 144(%rsp)\n"
+  "  movdqu %xmm10, 160(%rsp)\n"
+  "  movdqu %xmm11, 176(%rsp)\n"
+  "  movdqu %xmm12, 192(%rsp)\n"
+  "  movdqu %xmm13, 208(%rsp)\n"
+  "  movdqu %xmm14, 224(%rsp)\n"
+  "  movdqu %xmm15, 240(%rsp)\n"
+  "  movq 336(%rsp), %rdi\n"       // Return address into patched function
+  "  leaq 344(%rsp), %rsi\n"       // Slot holding caller's return address
+  "  call rtimers_patch_enter\n"
+  "  movdqu 0(%rsp), %xmm0\n"
+  "  movdqu 16(%rsp), %xmm1\n"
+  "  movdqu 32(%rsp), %xmm2\n"
+  "  movdqu 48(%rsp), %xmm3\n"
+  "  movdqu 64(%rsp), %xmm4\n"
+  "  movdqu 80(%rsp), %xmm5\n"
+  "  movdqu 96(%rsp), %xmm6\n"
+  "  movdqu 112(%rsp), %xmm7\n"
+  "  movdqu 128(%rsp), %xmm8\n"
+  "  movdqu 144(%rsp), %xmm9\n"
+  "  movdqu 160(%rsp), %xmm10\n"
+  "  movdqu 176(%rsp), %xmm11\n"
+  "  movdqu 192(%rsp), %xmm12\n"
+  "  movdqu 208(%rsp), %xmm13\n"
+  "  movdqu 224(%rsp), %xmm14\n"
+  "  movdqu 240(%rsp), %xmm15\n"
+  "  addq $264, %rsp\n"
+  "  popq %r11\n"
+  "  popq %r10\n"
+  "  popq %r9\n"
+  "  popq %r8\n"
+  "  popq %rdi\n"
+  "  popq %rsi\n"
+  "  popq %rdx\n"
+  "  popq %rcx\n"
+  "  popq %rax\n"
+  "  ret\n"
+  ".size rtimers_patch_entry_tramp, .-rtimers_patch_entry_tramp\n"
+  "\n"
+  ".p2align 4\n"
+  ".globl rtimers_patch_exit_tramp\n"
+  ".hidden rtimers_patch_exit_tramp\n"
+  ".type rtimers_patch_exit_tramp, @function\n"
+  "rtimers_patch_exit_tramp:\n"
+  "  subq $8, %rsp\n"
+  "  pushq %rax\n"
+  "  pushq %rcx\n"
+  "  pushq %rdx\n"
+  "  pushq %rsi\n"
+  "  pushq %rdi\n"
+  "  pushq %r8\n"
+  "  pushq %r9\n"
+  "  pushq %r10\n"
+  "  pushq %r11\n"
+  "  subq $256, %rsp\n"
+  "  movdqu %xmm0, 0(%rsp)\n"
+  "  movdqu %xmm1, 16(%rsp)\n"
+  "  movdqu %xmm2, 32(%rsp)\n"
+  "  movdqu %xmm3, 48(%rsp)\n"
+  "  movdqu %xmm4, 64(%rsp)\n"
+  "  movdqu %xmm5, 80(%rsp)\n"
+  "  movdqu %xmm6, 96(%rsp)\n"
+  "  movdqu %xmm7, 112(%rsp)\n"
+  "  movdqu %xmm8, 128(%rsp)\n"
+  "  movdqu %xmm9, 144(%rsp)\n"
+  "  movdqu %xmm10, 160(%rsp)\n"
+  "  movdqu %xmm11, 176(%rsp)\n"
+  "  movdqu %xmm12, 192(%rsp)\n"
+  "  movdqu %xmm13, 208(%rsp)\n"
+  "  movdqu %xmm14, 224(%rsp)\n"
+  "  movdqu %xmm15, 240(%rsp)\n"
+  "  call rtimers_patch_exit\n"
+  "  movq %rax, 328(%rsp)\n"       // Original return address, for final ret
+  "  movdqu 0(%rsp), %xmm0\n"
+  "  movdqu 16(%rsp), %xmm1\n"
+  "  movdqu 32(%rsp), %xmm2\n"
+  "  movdqu 48(%rsp), %xmm3\n"
+  "  movdqu 64(%rsp), %xmm4\n"
+  "  movdqu 80(%rsp), %xmm5\n"
+  "  movdqu 96(%rsp), %xmm6\n"
+  "  movdqu 112(%rsp), %xmm7\n"
+  "  movdqu 128(%rsp), %xmm8\n"
+  "  movdqu 144(%rsp), %xmm9\n"
+  "  movdqu 160(%rsp), %xmm10\n"
+  "  movdqu 176(%rsp), %xmm11\n"
+  "  movdqu 192(%rsp), %xmm12\n"
+  "  movdqu 208(%rsp), %xmm13\n"
+  "  movdqu 224(%rsp), %xmm14\n"
+  "  movdqu 240(%rsp), %xmm15\n"
+  "  addq $256, %rsp\n"
+  "  popq %r11\n"
+  "  popq %r10\n"
+  "  popq %r9\n"
+  "  popq %r8\n"
+  "  popq %rdi\n"
+  "  popq %rsi\n"
+  "  popq %rdx\n"
+  "  popq %rcx\n"
+  "  popq %rax\n"
+  "  ret\n"
+  ".size rtimers_patch_exit_tramp, .-rtimers_patch_exit_tramp\n"
+);
+#else
+void rtimers_patch_entry_tramp() {}
+void rtimers_patch_exit_tramp() {}
+#endif  // RTIMERS_PATCH_SUPPORTED
+
+
+namespace rtimers {
+  namespace patch {
+
+namespace {
+
+int chosenScrubSignal = 0;         // Zero selects SIGRTMAX-3
+bool handlersInstalled = false;
+
+//! Signal used to move other threads out of a sled which is being rewritten
+inline int scrubSignal() {
+  return (chosenScrubSignal ? chosenScrubSignal : SIGRTMAX - 3);
+}
+
+std::atomic<unsigned> scrubAcks(0);
+struct sigaction prevTrapAction;
+bool syncCoreRegistered = false;
+
+
+#if RTIMERS_PATCH_SUPPORTED
+inline greg_t& programCounter(void* context) {
+  return static_cast<ucontext_t*>(context)->uc_mcontext.gregs[REG_RIP];
+}
+
+//! Find the sled (if any) of which an address is one of the trailing bytes
+uintptr_t sledContaining(uintptr_t pc) {
+  for (uintptr_t k=1; k<sledSize; ++k) {
+    if (findEntry(pc - k)) return pc - k;
+  }
+  return 0;
+}
+
+//! Step over a sled whose first byte has been replaced by a breakpoint
+void onTrap(int sig, siginfo_t* info, void* context) {
+  greg_t& pc = programCounter(context);
+  const uintptr_t sled = uintptr_t(pc) - 1;
+
+  if (findEntry(sled)) {
+    pc = greg_t(sled + sledSize);
+    return;
+  }
+
+  // Not one of our breakpoints, so defer to any previous handler:
+  if (prevTrapAction.sa_flags & SA_SIGINFO) {
+    prevTrapAction.sa_sigaction(sig, info, context);
+  } else if (prevTrapAction.sa_handler == SIG_DFL) {
+    signal(sig, SIG_DFL);
+    raise(sig);
+  } else if (prevTrapAction.sa_handler != SIG_IGN) {
+    prevTrapAction.sa_handler(sig);
+  }
+}
+
+//! Move a thread which was interrupted part-way through a sled to its end
+void onScrub(int, siginfo_t*, void* context) {
+  greg_t& pc = programCounter(context);
+  const uintptr_t sled = sledContaining(uintptr_t(pc));
+
+  if (sled) pc = greg_t(sled + sledSize);
+  scrubAcks.fetch_add(1);
+}
+#endif  // RTIMERS_PATCH_SUPPORTED
+
+
+//! Install signal handlers needed while rewriting sleds (called with patchMtx held)
+bool installHandlers() {
+#if RTIMERS_PATCH_SUPPORTED
+  if (handlersInstalled) return true;
+
+  // Refuse to displace a handler which the application relies upon:
+  struct sigaction existing;
+  if (sigaction(scrubSignal(), NULL, &existing) != 0
+      || (existing.sa_flags & SA_SIGINFO)
+      || (existing.sa_handler != SIG_DFL && existing.sa_handler != SIG_IGN)) {
+    return false;
+  }
+
+  struct sigaction action;
+  std::memset(&action, 0, sizeof(action));
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_SIGINFO | SA_RESTART;
+
+  action.sa_sigaction = &onTrap;
+  if (sigaction(SIGTRAP, &action, &prevTrapAction) != 0) return false;
+  action.sa_sigaction = &onScrub;
+  if (sigaction(scrubSignal(), &action, NULL) != 0) {
+    sigaction(SIGTRAP, &prevTrapAction, NULL);
+    return false;
+  }
+
+#  ifdef __NR_membarrier
+  syncCoreRegistered = (syscall(__NR_membarrier,
+                         MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED_SYNC_CORE,
+                         0) == 0);
+#  endif
+
+  handlersInstalled = true;
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+/*! Interrupt all other threads, so that none is left part-way through a sled
+ *
+ *  This returns false if any thread fails to respond within a second,
+ *  e.g. because it is blocking the scrubbing signal.
+ */
+bool scrubThreads() {
+  DIR* dir = opendir("/proc/self/task");
+  if (!dir) return false;
+
+  const pid_t pid = getpid();
+  const pid_t self = pid_t(syscall(SYS_gettid));
+  unsigned sent = 0;
+
+  scrubAcks.store(0);
+  while (const dirent* item = readdir(dir)) {
+    const pid_t tid = pid_t(std::atoi(item->d_name));
+    if (tid <= 0 || tid == self) continue;
+    if (syscall(SYS_tgkill, pid, tid, scrubSignal()) == 0) ++sent;
+  }
+  closedir(dir);
+
+  const unsigned long long deadline = nowNs() + scrubTimeoutNs;
+  while (scrubAcks.load() < sent) {
+    if (nowNs() > deadline) return false;
+    sched_yield();
+  }
+
+  return true;
+}
+
+
+//! Ensure that all threads will fetch freshly modified instructions
+bool syncCores() {
+#ifdef __NR_membarrier
+  if (syncCoreRegistered) {
+    return (syscall(__NR_membarrier,
+                    MEMBARRIER_CMD_PRIVATE_EXPEDITED_SYNC_CORE, 0) == 0);
+  }
+#endif
+
+  // Each interrupted thread passes through the kernel, which serializes it:
+  return scrubThreads();
+}
+
+
+/*! Replace the bytes of a sled, while other threads may be executing it
+ *
+ *  This follows the three-phase sequence of the kernel's text_poke_bp():
+ *  the first byte becomes a breakpoint, which onTrap() steps over,
+ *  then the remaining bytes are rewritten, and finally the first byte.
+ *  Because the unpatched sled consists of five single-byte NOPs,
+ *  threads which had already started executing it are moved
+ *  to its end before its trailing bytes are changed.
+ */
+bool writeSled(uintptr_t sled, const unsigned char* bytes) {
+  const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+  const uintptr_t first = sled & ~(pageSize - 1);
+  const uintptr_t last = (sled + sledSize - 1) & ~(pageSize - 1);
+  void* pages = reinterpret_cast<void*>(first);
+  const size_t length = last + pageSize - first;
+  unsigned char* code = reinterpret_cast<unsigned char*>(sled);
+
+  if (mprotect(pages, length, PROT_READ | PROT_WRITE | PROT_EXEC) != 0) {
+    return false;
+  }
+
+  const unsigned char previous = code[0];
+  __atomic_store_n(code, breakpoint, __ATOMIC_SEQ_CST);
+
+  const bool ok = syncCores() && scrubThreads();
+  if (ok) {
+    std::memcpy(code + 1, bytes + 1, sledSize - 1);
+    syncCores();
+    __atomic_store_n(code, bytes[0], __ATOMIC_SEQ_CST);
+  } else {
+    __atomic_store_n(code, previous, __ATOMIC_SEQ_CST);
+  }
+  syncCores();
+
+  mprotect(pages, length, PROT_READ | PROT_EXEC);
+
+  return ok;
+}
+
+//! Find the sled of a named function
+uintptr_t findSled(const std::string& name) {
+  if (!__start___patchable_function_entries) return 0;
+
+  for (const uintptr_t* itr = __start___patchable_function_entries;
+       itr != __stop___patchable_function_entries; ++itr) {
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void*>(*itr), &info) && info.dli_sname
+        && nameMatches(info.dli_sname, name)) {
+      return *itr;
+    }
+  }
+
+  return 0;
+}
+
+}   // namespace (anonymous)
+
+
+bool setScrubSignal(int sig) {
+  std::lock_guard<std::mutex> lock(patchMtx);
+
+  if (handlersInstalled || sig <= 0 || sig >= NSIG) return false;
+  chosenScrubSignal = sig;
+  return true;
+}
+
+
+bool isSupported() {
+  return RTIMERS_PATCH_SUPPORTED
+          && (__start___patchable_function_entries != NULL);
+}
+
+
+std::vector<std::string> listPatchable() {
+  std::vector<std::string> names;
+  if (!__start___patchable_function_entries) return names;
+
+  for (const uintptr_t* itr = __start___patchable_function_entries;
+       itr != __stop___patchable_function_entries; ++itr) {
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void*>(*itr), &info) && info.dli_sname) {
+      names.push_back(demangle(info.dli_sname));
+    }
+  }
+
+  return names;
+}
+
+
+bool patchFunction(const std::string& name) {
+  if (!RTIMERS_PATCH_SUPPORTED) return false;
+
+  std::lock_guard<std::mutex> lock(patchMtx);
+
+  Entry* entry = NULL;
+  const std::map<std::string, Entry*>::iterator itr = entries.find(name);
+
+  if (itr != entries.end()) {
+    entry = itr->second;
+    if (entry->info.active) return true;
+  } else {
+    const uintptr_t sled = findSled(name);
+    if (!sled || !installHandlers()) return false;
+
+    const intptr_t rel = reinterpret_cast<intptr_t>(&rtimers_patch_entry_tramp)
+                          - static_cast<intptr_t>(sled + sledSize);
+    if (rel != static_cast<int32_t>(rel)) return false;
+
+    entry = new Entry;
+    entry->sled = sled;
+    std::memcpy(entry->original, reinterpret_cast<const void*>(sled), sledSize);
+    entry->info.name = name;
+    entry->info.active = false;
+    entry->timer = &Registry::global().lookup(name);
+
+    if (!insertEntry(entry)) {
+      delete entry;
+      return false;
+    }
+    entries[name] = entry;
+  }
+
+  const int32_t rel = static_cast<int32_t>(
+                          reinterpret_cast<intptr_t>(&rtimers_patch_entry_tramp)
+                          - static_cast<intptr_t>(entry->sled + sledSize));
+  unsigned char call[sledSize] = { 0xe8 };
+  std::memcpy(call + 1, &rel, sizeof(rel));
+
+  if (!writeSled(entry->sled, call)) return false;
+  entry->info.active = true;
+
+  return true;
+}
+
+
+bool unpatchFunction(const std::string& name) {
+  std::lock_guard<std::mutex> lock(patchMtx);
+
+  const std::map<std::string, Entry*>::iterator itr = entries.find(name);
+  if (itr == entries.end() || !itr->second->info.active) return false;
+
+  Entry* entry = itr->second;
+  if (!writeSled(entry->sled, entry->original)) return false;
+  entry->info.active = false;
+
+  return true;
+}
+
+
+std::vector<PatchedStats> collect() {
+  std::lock_guard<std::mutex> lock(patchMtx);
+  std::vector<PatchedStats> functions;
+
+  for (std::map<std::string, Entry*>::const_iterator itr = entries.begin();
+       itr != entries.end(); ++itr) {
+    std::lock_guard<std::mutex> statsLock(itr->second->mtx);
+    functions.push_back(itr->second->info);
+  }
+
+  return functions;
+}
+
+
+  }   // namespace patch
+}   // namespace rtimers
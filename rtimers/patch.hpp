@@ -0,0 +1,109 @@
+/*
+ *  Run-time patching of function timing via -fpatchable-function-entry
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*  Code compiled with -fpatchable-function-entry=5 has a five-byte
+ *  sled of NOPs at the start of each function, which costs almost
+ *  nothing when executed. The accompanying translation unit
+ *  (rtimers/patch.cpp) can overwrite the sleds of selected functions
+ *  with calls into timing trampolines, and restore them later,
+ *  while the program runs. That translation unit must not itself be
+ *  compiled with -fpatchable-function-entry, and executables should be
+ *  linked with -rdynamic so that functions can be found by name.
+ *
+ *  Durations of patched functions are also added to the timer of the
+ *  same name in Registry::global(), alongside the statistics returned
+ *  by collect().
+ *
+ *  Sleds are rewritten without stopping the program, but doing so
+ *  briefly interrupts every other thread with a scrubbing signal
+ *  (SIGRTMAX-3, unless changed by setScrubSignal()),
+ *  and steps over the temporary breakpoint via a SIGTRAP handler.
+ *  Patching therefore fails if any thread blocks the scrubbing signal,
+ *  or if the application has already installed a handler for it.
+ *
+ *  Patching is currently only supported on x86_64 Linux.
+ *  Functions through which exceptions may propagate should not
+ *  be patched, because their return addresses are redirected
+ *  through a trampoline which the unwinder cannot interpret.
+ *  For the same reason, patched functions crash programs running
+ *  with CET shadow stacks (e.g. built with -fcf-protection=return
+ *  and run with glibc.cpu.x86_shstk enabled), because the hardware
+ *  rejects the redirected return.
+ *  Similarly, functions returning "long double" values are unsupported.
+ */
+
+#ifndef _RTIMERS_PATCH_HPP
+#define _RTIMERS_PATCH_HPP
+
+#if __cplusplus < 201100
+#  error "rtimers/patch requires C++11 support"
+#endif
+
+#include <string>
+#include <vector>
+
+#include "core.hpp"
+
+
+namespace rtimers {
+  namespace patch {
+
+
+//! Timing statistics of a function which has been patched
+struct PatchedStats
+{
+  std::string name;       //!< Symbol name, as supplied to patchFunction()
+  bool active;            //!< Whether the function is currently patched
+  VarBoundStats stats;    //!< Accumulated call durations
+};
+
+
+/*! Choose the signal used to interrupt threads while sleds are rewritten
+ *
+ *  This must be called before any function is first patched,
+ *  and returns false if it is too late, or if the signal is invalid.
+ */
+bool setScrubSignal(int sig);
+
+//! Check whether run-time patching is supported on this platform
+bool isSupported();
+
+//! List names of all functions which have patchable entry sleds
+std::vector<std::string> listPatchable();
+
+/*! Redirect a function's entry sled into the timing trampoline
+ *
+ *  The function may be identified by its mangled or demangled name,
+ *  with the parameter list being optional in the latter case.
+ *  This returns false if the function cannot be found or patched.
+ */
+bool patchFunction(const std::string& name);
+
+//! Restore a function's entry sled to NOPs
+bool unpatchFunction(const std::string& name);
+
+//! Gather statistics of all functions which have ever been patched
+std::vector<PatchedStats> collect();
+
+//! Report statistics of all patched functions via a timer logger
+template <typename LOG=StderrLogger>
+void report() {
+  const std::vector<PatchedStats> functions = collect();
+
+  for (size_t i=0; i<functions.size(); ++i) {
+    LOG::report(functions[i].name, functions[i].stats);
+  }
+}
+
+
+  }   // namespace patch
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_PATCH_HPP */
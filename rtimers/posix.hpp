@@ -77,14 +77,16 @@ class ThreadManager
       startTimes->insert(itr, typename TimeMap::value_type(this, CLK::now()));
     }
 
-    void updateStats(const Instant& now, STATS& stats) {
+    double updateStats(const Instant& now, STATS& stats) {
       TimeMap* startTimes = static_cast<TimeMap*>(
                                               pthread_getspecific(start_key));
       const double duration = CLK::interval((*startTimes)[this], now);
 
       pthread_mutex_lock(&stats_mtx);
-      stats.addSample(duration);
+      addTimedSample(stats, duration, now);
       pthread_mutex_unlock(&stats_mtx);
+
+      return duration;
     }
 
   protected:
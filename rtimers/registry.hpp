@@ -0,0 +1,974 @@
+/*
+ *  Process-wide registry of named timing statistics
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_REGISTRY_HPP
+#define _RTIMERS_REGISTRY_HPP
+
+#if __cplusplus < 201100
+#  error "rtimers/registry requires C++11 support"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core.hpp"
+#include "ftrace.hpp"
+#include "shards.hpp"
+
+
+namespace rtimers {
+
+
+/** Accumulate time intervals into a logarithmic histogram
+ *
+ *  Intervals are counted in buckets spaced at four per decade
+ *  above one nanosecond, which allows percentiles to be estimated
+ *  to within about 30%, and allows histograms to be merged or subtracted,
+ *  e.g. to find the distribution of samples between two snapshots.
+ */
+struct HistogramStats : public BoundStats
+{
+  enum { PERDECADE = 4, NBUCKETS = 48 };
+
+  HistogramStats()
+    : total(0.0) {
+    for (unsigned b=0; b<NBUCKETS; ++b) buckets[b] = 0;
+  }
+
+  void addSample(double dt) {
+    BoundStats::addSample(dt);
+    total += dt;
+    ++buckets[bucketIndex(dt)];
+  }
+
+  double getMean() const {
+    return (count > 0 ? total / count : 0.0);
+  }
+
+  //! Estimate a percentile (0 < p < 1) from the bucket counts
+  double percentile(double p) const {
+    if (count == 0) return 0.0;
+
+    const double rank = p * count;
+    unsigned long seen = 0;
+    for (unsigned b=0; b<NBUCKETS; ++b) {
+      seen += buckets[b];
+      if (seen >= rank && buckets[b] > 0) {
+        const double mid = std::sqrt(bucketEdge(b) * bucketEdge(b + 1));
+        return std::min(std::max(mid, tmin), tmax);
+      }
+    }
+    return tmax;
+  }
+
+  //! Merge samples from another accumulator
+  HistogramStats& operator+=(const HistogramStats& other) {
+    count += other.count;
+    total += other.total;
+    tmin = std::min(tmin, other.tmin);
+    tmax = std::max(tmax, other.tmax);
+    for (unsigned b=0; b<NBUCKETS; ++b) buckets[b] += other.buckets[b];
+    return *this;
+  }
+
+  /*! Find the samples added since an earlier copy of this accumulator
+   *
+   *  The bounds of the result are estimated from the occupied buckets.
+   *  If the accumulator has since been reset, all of its samples are
+   *  treated as new.
+   */
+  HistogramStats since(const HistogramStats& earlier) const {
+    // If any count has gone backwards, the accumulator was reset in between:
+    bool wasReset = (count < earlier.count);
+    for (unsigned b=0; b<NBUCKETS; ++b) {
+      wasReset = wasReset || (buckets[b] < earlier.buckets[b]);
+    }
+    if (wasReset) return *this;
+
+    HistogramStats delta;
+
+    delta.count = count - earlier.count;
+    delta.total = total - earlier.total;
+    for (unsigned b=0; b<NBUCKETS; ++b) {
+      delta.buckets[b] = buckets[b] - earlier.buckets[b];
+      if (delta.buckets[b] > 0) {
+        delta.tmin = std::min(delta.tmin, std::max(bucketEdge(b), tmin));
+        delta.tmax = std::max(delta.tmax, std::min(bucketEdge(b + 1), tmax));
+      }
+    }
+    return delta;
+  }
+
+  static double bucketEdge(unsigned b) {
+    return 1e-9 * std::pow(10.0, double(b) / PERDECADE);
+  }
+
+  //! Find a bucket by binary search of its edges, avoiding a logarithm
+  static unsigned bucketIndex(double dt) {
+    static const Edges edges;
+    const double* upper = std::upper_bound(edges.edge + 1,
+                                           edges.edge + NBUCKETS, dt);
+    return unsigned(upper - edges.edge) - 1;
+  }
+
+  struct Edges
+  {
+    Edges() {
+      for (unsigned b=0; b<NBUCKETS; ++b) edge[b] = bucketEdge(b);
+    }
+
+    double edge[NBUCKETS];
+  };
+
+  double total;
+  unsigned long buckets[NBUCKETS];
+};
+
+inline std::ostream& operator<<(std::ostream& os,
+                                const HistogramStats& stats) {
+  const double median = stats.percentile(0.5);
+  const TimeUnit tu = stats.guessUnit(median);
+
+  os << "<t> = " << (stats.getMean() * tu.mult) << tu.unit << ", "
+     << "p50 = " << (median * tu.mult) << tu.unit << ", "
+     << "p99 = " << (stats.percentile(0.99) * tu.mult) << tu.unit << ", "
+     << static_cast<const BoundStats&>(stats);
+  return os;
+}
+
+
+/** Statistics gathered by one thread for one registry entry
+ *
+ *  Each shard occupies its own cache lines, on the NUMA node
+ *  of the thread which created it, so that the only cross-node traffic
+ *  arises when the shards are merged for reporting.
+ *  Only the owning thread adds samples, which it does without locking
+ *  or atomic read-modify-write instructions, by updating the statistics
+ *  within a sequence lock, from which other threads read consistent copies.
+ */
+struct RegistryShard
+{
+  RegistryShard()
+    : node(0), tid(0), calls(0), seq(0), count(0),
+      total(0.0), tmin(1e18), tmax(-1e18) {
+    for (unsigned b=0; b<HistogramStats::NBUCKETS; ++b) buckets[b].store(0);
+  }
+
+  //! Add a sample, standing for a number of calls, from the owning thread
+  void add(double dt, unsigned long weight=1) {
+    const std::memory_order relaxed = std::memory_order_relaxed;
+    const unsigned long sq = seq.load(relaxed);
+    seq.store(sq + 1, relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    count.store(count.load(relaxed) + weight, relaxed);
+    total.store(total.load(relaxed) + weight * dt, relaxed);
+    if (dt < tmin.load(relaxed)) tmin.store(dt, relaxed);
+    if (dt > tmax.load(relaxed)) tmax.store(dt, relaxed);
+    std::atomic<unsigned long>& bucket =
+                                  buckets[HistogramStats::bucketIndex(dt)];
+    bucket.store(bucket.load(relaxed) + weight, relaxed);
+
+    seq.store(sq + 2, std::memory_order_release);
+  }
+
+  //! Copy all samples added so far, from any thread
+  HistogramStats read() const {
+    const std::memory_order relaxed = std::memory_order_relaxed;
+    HistogramStats copy;
+
+    for (;;) {
+      const unsigned long sq = seq.load(std::memory_order_acquire);
+      if (sq & 1) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      copy.count = count.load(relaxed);
+      copy.total = total.load(relaxed);
+      copy.tmin = tmin.load(relaxed);
+      copy.tmax = tmax.load(relaxed);
+      for (unsigned b=0; b<HistogramStats::NBUCKETS; ++b) {
+        copy.buckets[b] = buckets[b].load(relaxed);
+      }
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq.load(relaxed) == sq) return copy;
+    }
+  }
+
+  //! Copy the samples added since the last reset (with mtx held)
+  HistogramStats sinceReset() const {
+    return read().since(baseline);
+  }
+
+  int node;                   //!< NUMA node holding this shard
+  long tid;                   //!< Kernel id of the thread owning this shard
+  std::string thread;         //!< Name of that thread, when first sampled
+  unsigned long calls;        //!< Samples offered, used only by the owner
+  std::mutex mtx;             //!< Protects the baseline, used only by readers
+  HistogramStats baseline;    //!< Samples already discarded by a reset
+
+  std::atomic<unsigned long> seq;   //!< Odd while the owner is adding
+  std::atomic<unsigned long> count;
+  std::atomic<double> total, tmin, tmax;
+  std::atomic<unsigned long> buckets[HistogramStats::NBUCKETS];
+};
+
+
+/** Recipient of every sample added to a RegistryEntry
+ *
+ *  This is called by the timed thread, so should be cheap and lock-free.
+ *
+ *  \see RegistryEntry::setObserver()
+ */
+class SampleObserver
+{
+  public:
+    virtual ~SampleObserver() {}
+    virtual void observe(double dt) = 0;
+};
+
+
+/** Statistics gathered by one thread, labelled by its name
+ *
+ *  \see ThreadBreakdown
+ */
+struct ThreadStats
+{
+  std::string thread;         //!< Name of the thread (or its id if unnamed)
+  long tid;
+  int node;
+  HistogramStats stats;
+};
+
+
+/** Per-thread table through which the entries of one Registry find shards
+ *
+ *  Each Registry owns a table number, which indexes a thread-local
+ *  array of tables, each of which is indexed by entry id.
+ *  Numbers are recycled when a registry is destroyed, so each table
+ *  also carries a generation, which lets threads discard stale copies.
+ */
+class ShardTable
+{
+  public:
+    ShardTable()
+      : number(acquire()), generation(nextGeneration()) {}
+    ShardTable(const ShardTable&) = delete;
+    ShardTable& operator=(const ShardTable&) = delete;
+
+    ~ShardTable() {
+      std::lock_guard<std::mutex> lock(poolMutex());
+      freeNumbers().push_back(number);
+    }
+
+    //! Find the calling thread's copy of this table
+    std::vector<RegistryShard*>& local() const {
+      static thread_local std::vector<Local> tables;
+
+      if (number >= tables.size()) tables.resize(number + 1);
+      Local& table = tables[number];
+      if (table.generation != generation) {
+        std::vector<RegistryShard*>().swap(table.shards);
+        table.generation = generation;
+      }
+      return table.shards;
+    }
+
+  protected:
+    struct Local
+    {
+      Local()
+        : generation(0) {}
+
+      unsigned long generation;
+      std::vector<RegistryShard*> shards;
+    };
+
+    const unsigned number;
+    const unsigned long generation;
+
+    static unsigned acquire() {
+      static unsigned count = 0;
+      std::lock_guard<std::mutex> lock(poolMutex());
+      std::vector<unsigned>& pool = freeNumbers();
+
+      if (pool.empty()) return count++;
+      const unsigned recycled = pool.back();
+      pool.pop_back();
+      return recycled;
+    }
+
+    static unsigned long nextGeneration() {
+      static std::atomic<unsigned long> generations(0);
+      return ++generations;
+    }
+
+    static std::mutex& poolMutex() {
+      static std::mutex mtx;
+      return mtx;
+    }
+
+    static std::vector<unsigned>& freeNumbers() {
+      static std::vector<unsigned> pool;
+      return pool;
+    }
+};
+
+
+/** Statistics of a single named timer held within a Registry
+ *
+ *  Each thread adding samples to an entry does so via its own shard,
+ *  allocated on that thread's NUMA node, which it locates through
+ *  its registry's ShardTable, indexed by the entry's id.
+ *  Entries are never destroyed while their registry exists,
+ *  so references to them, and their ids, remain valid.
+ *  Destroying an entry destroys its shards, whose memory is then reused.
+ */
+class RegistryEntry
+{
+  public:
+    RegistryEntry(const std::string& label, unsigned ident,
+                  const ShardTable& shardTable)
+      : name(label), id(ident), flags(ENABLED), observer(nullptr),
+        observing(0), table(shardTable) {}
+    RegistryEntry(const RegistryEntry&) = delete;
+    RegistryEntry& operator=(const RegistryEntry&) = delete;
+
+    ~RegistryEntry() {
+      for (auto shard : shards) {
+        const int node = shard->node;
+        shard->~RegistryShard();
+        numa::LocalArena::release(shard, sizeof(RegistryShard), node);
+      }
+    }
+
+    /*! Control flags, which are combined into a single word
+     *
+     *  Bits above SAMPLE_SHIFT hold the base-two logarithm of
+     *  the sampling period, e.g. 3 to record one sample in every eight,
+     *  each recorded sample then being counted eight times, so that
+     *  counts and totals remain estimates of all samples.
+     */
+    enum Flags { ENABLED = 1, TRACED = 2, SAMPLE_SHIFT = 8 };
+
+    static unsigned makeFlags(bool enabled, bool traced=false,
+                              unsigned logPeriod=0) {
+      return (enabled ? ENABLED : 0) | (traced ? TRACED : 0)
+              | (std::min(logPeriod, 31u) << SAMPLE_SHIFT);
+    }
+
+    void addSample(double dt) {
+      // Observers see samples even while statistics are disabled:
+      if (observer.load(std::memory_order_relaxed)) notify(dt);
+
+      const unsigned mode = flags.load(std::memory_order_relaxed);
+      if (!(mode & ENABLED)) return;
+
+      RegistryShard& shard = localShard();
+      const unsigned logPeriod = mode >> SAMPLE_SHIFT;
+      if (logPeriod > 0
+          && (shard.calls++ & ((1ul << logPeriod) - 1)) != 0) return;
+
+      shard.add(dt, 1ul << logPeriod);
+    }
+
+    //! Take a consistent copy of the accumulated statistics
+    HistogramStats read() const {
+      HistogramStats total;
+      for (auto& node : readByNode()) total += node.second;
+      return total;
+    }
+
+    //! Merge the statistics of all shards held on each NUMA node
+    std::map<int, HistogramStats> readByNode() const {
+      std::map<int, HistogramStats> nodes;
+      for (auto shard : list()) {
+        std::lock_guard<std::mutex> lock(shard->mtx);
+        nodes[shard->node] += shard->sinceReset();
+      }
+      return nodes;
+    }
+
+    //! Copy the statistics of each thread which has added samples
+    std::vector<ThreadStats> readByThread() const {
+      std::vector<ThreadStats> rows;
+      for (auto shard : list()) {
+        std::lock_guard<std::mutex> lock(shard->mtx);
+        rows.push_back(ThreadStats{ shard->thread, shard->tid,
+                                    shard->node, shard->sinceReset() });
+      }
+      return rows;
+    }
+
+    /*! Discard the statistics accumulated so far
+     *
+     *  Shards are left untouched by this, so that their owners never lock,
+     *  and later readings subtract a copy taken now. The bounds of samples
+     *  added after a reset are therefore estimated from the histogram.
+     */
+    void reset() {
+      for (auto shard : list()) {
+        std::lock_guard<std::mutex> lock(shard->mtx);
+        shard->baseline = shard->read();
+      }
+    }
+
+    //! Start or stop accepting samples
+    void setEnabled(bool on) {
+      if (on) flags.fetch_or(ENABLED, std::memory_order_relaxed);
+      else flags.fetch_and(~unsigned(ENABLED), std::memory_order_relaxed);
+    }
+
+    bool isEnabled() const {
+      return (getFlags() & ENABLED) != 0;
+    }
+
+    //! Replace all control flags at once
+    void setFlags(unsigned mode) {
+      flags.store(mode, std::memory_order_relaxed);
+    }
+
+    unsigned getFlags() const {
+      return flags.load(std::memory_order_relaxed);
+    }
+
+    /*! Pass all future samples to an observer (or none, if NULL)
+     *
+     *  Samples are observed whether or not the entry is enabled.
+     *  Only one observer may be attached at once, so this returns false
+     *  if another is already attached. Detaching an observer waits for
+     *  any calls to it which are in progress on other threads,
+     *  so must not be done from within SampleObserver::observe().
+     */
+    bool setObserver(SampleObserver* obs) {
+      if (obs) {
+        SampleObserver* none = nullptr;
+        return observer.compare_exchange_strong(none, obs);
+      }
+
+      observer.store(nullptr);
+      while (observing.load() > 0) std::this_thread::yield();
+      return true;
+    }
+
+    const std::string name;
+    const unsigned id;
+
+  protected:
+    std::atomic<unsigned> flags;
+    std::atomic<SampleObserver*> observer;
+    std::atomic<unsigned> observing;  //!< Calls to observer in progress
+    const ShardTable& table;  //!< Per-thread shards, indexed by id
+    mutable std::mutex mtx;   //!< Protects the list of shards
+    std::vector<RegistryShard*> shards;
+
+    //! Pass a sample to the observer, unless it is being detached
+    void notify(double dt) {
+      // Announce the call before checking the observer once more,
+      // so that setObserver(NULL) either waits for it or prevents it:
+      observing.fetch_add(1);
+      SampleObserver* obs = observer.load();
+      if (obs) obs->observe(dt);
+      observing.fetch_sub(1, std::memory_order_release);
+    }
+
+    RegistryShard& localShard() {
+      std::vector<RegistryShard*>& local = table.local();
+
+      if (id < local.size() && local[id]) return *local[id];
+      if (id >= local.size()) local.resize(id + 1, NULL);
+
+      int node = 0;
+      void* mem = numa::LocalArena::local().allocate(sizeof(RegistryShard),
+                                                     node);
+      RegistryShard* shard = new (mem) RegistryShard;
+      shard->node = node;
+      labelThread(*shard);
+      local[id] = shard;
+
+      std::lock_guard<std::mutex> lock(mtx);
+      shards.push_back(shard);
+      return *shard;
+    }
+
+    std::vector<RegistryShard*> list() const {
+      std::lock_guard<std::mutex> lock(mtx);
+      return shards;
+    }
+
+    static void labelThread(RegistryShard& shard) {
+#if defined(__linux) && defined(SYS_gettid)
+      shard.tid = syscall(SYS_gettid);
+#endif
+#if defined(__GLIBC__)
+      char label[64] = "";
+      if (pthread_getname_np(pthread_self(), label, sizeof(label)) == 0) {
+        shard.thread = label;
+      }
+#endif
+      if (shard.thread.empty()) shard.thread = std::to_string(shard.tid);
+    }
+};
+
+
+/** Per-thread rows of a timer's statistics
+ *
+ *  This exposes threads which are consistently slower than their peers,
+ *  e.g. through sharing a core with interrupt handling, which would be
+ *  hidden by merging all threads' samples. The spread is the ratio of the
+ *  largest to the smallest per-thread mean time.
+ *  Because rows are read from the per-thread shards of a RegistryEntry,
+ *  this adds no cost to timed threads.
+ *  Threads are labelled with the names they had when they first added
+ *  samples, so should be named (e.g. by pthread_setname_np()) before then.
+ *  \code
+ *  ThreadBreakdown(Registry::global().lookup("request")).report();
+ *  \endcode
+ */
+class ThreadBreakdown : public std::vector<ThreadStats>
+{
+  public:
+    ThreadBreakdown(const RegistryEntry& entry)
+      : name(entry.name) {
+      std::vector<ThreadStats> rows(entry.readByThread());
+      std::stable_sort(rows.begin(), rows.end(),
+                       [](const ThreadStats& a, const ThreadStats& b) {
+                         return a.thread < b.thread; });
+      assign(rows.begin(), rows.end());
+    }
+
+    //! Ratio of the slowest to the fastest per-thread mean time
+    double spread() const {
+      double lo = 0.0, hi = 0.0;
+      for (auto& row : *this) {
+        if (row.stats.count == 0) continue;
+        const double mean = row.stats.getMean();
+        if (lo <= 0.0 || mean < lo) lo = mean;
+        if (mean > hi) hi = mean;
+      }
+      return (lo > 0.0 ? hi / lo : 1.0);
+    }
+
+    //! Report each thread's statistics, and the spread, via a timer logger
+    template <typename LOG=StderrLogger>
+    void report() const {
+      for (auto& row : *this) {
+        LOG::report(name + "[" + row.thread + "]", row.stats);
+      }
+      LOG::report(name, *this);
+    }
+
+    const std::string name;
+};
+
+inline std::ostream& operator<<(std::ostream& os,
+                                const ThreadBreakdown& breakdown) {
+  os << "thread spread = " << breakdown.spread();
+  return os;
+}
+
+
+/** Copy of the statistics of all registered timers at one moment */
+struct RegistrySnapshot
+{
+  std::chrono::steady_clock::time_point taken;
+  std::map<std::string, HistogramStats> timers;
+};
+
+
+/** Change in one timer's statistics between two snapshots
+ *
+ *  The interval's distribution is compared with that of all samples
+ *  before the earlier snapshot using a two-sample Kolmogorov-Smirnov test
+ *  on the histogram buckets, with shapeChanged being set if the
+ *  distributions differ at the 1% significance level.
+ */
+struct TimerDelta
+{
+  std::string name;
+  HistogramStats interval;    //!< Samples taken between the snapshots
+  double baselineMean;        //!< Mean of samples before the first snapshot
+  double ksStatistic;         //!< Largest difference between the two CDFs
+  bool shapeChanged;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const TimerDelta& delta) {
+  const TimeUnit tu = BoundStats::guessUnit(delta.interval.total);
+  const TimeUnit tm = BoundStats::guessUnit(delta.interval.getMean());
+
+  os << "count +" << delta.interval.count
+     << ", total +" << (delta.interval.total * tu.mult) << tu.unit
+     << ", <t> = " << (delta.interval.getMean() * tm.mult) << tm.unit
+     << " (was " << (delta.baselineMean * tm.mult) << tm.unit << ")";
+  if (delta.shapeChanged) os << ", distribution changed (D = "
+                             << delta.ksStatistic << ")";
+  return os;
+}
+
+
+//! Per-timer changes between two snapshots
+class RegistryDiff : public std::vector<TimerDelta>
+{
+  public:
+    RegistryDiff()
+      : elapsed(0.0) {}
+
+    //! Sort with the largest increases in total time first
+    RegistryDiff& sortByTotal() {
+      std::stable_sort(begin(), end(),
+                       [](const TimerDelta& a, const TimerDelta& b) {
+                         return a.interval.total > b.interval.total; });
+      return *this;
+    }
+
+    //! Report each timer's changes via a timer logger
+    template <typename LOG=StderrLogger>
+    void report() const {
+      for (auto& delta : *this) LOG::report(delta.name, delta);
+    }
+
+    double elapsed;     //!< Time between snapshots (seconds)
+};
+
+
+/** Change of flags for registry entries whose names have a given prefix
+ *
+ *  \see Registry::setRules(), TimerControl
+ */
+struct RegistryRule
+{
+  std::string prefix;
+  int enabled, traced, logPeriod;   //!< -1 if unchanged
+
+  void update(RegistryRule& flags) const {
+    if (enabled >= 0) flags.enabled = enabled;
+    if (traced >= 0) flags.traced = traced;
+    if (logPeriod >= 0) flags.logPeriod = logPeriod;
+  }
+};
+
+
+/** Collection of named timers, shared across a process
+ *
+ *  Timers based on RegisteredManager feed their samples into an
+ *  entry of the global registry, which is created when a timer of
+ *  that name is first constructed. The registry as a whole can then
+ *  be snapshotted, e.g. at the end of a warm-up phase and at the
+ *  end of a load phase, and the snapshots compared to find what changed.
+ *  \code
+ *  const RegistrySnapshot warm = Registry::global().snapshot();
+ *  runLoadPhase();
+ *  Registry::diff(warm, Registry::global().snapshot())
+ *    .sortByTotal().report();
+ *  \endcode
+ *
+ *  \see RegisteredManager, HistogramStats
+ */
+class Registry
+{
+  public:
+    Registry() {
+      for (unsigned c=0; c<NCHUNKS; ++c) chunks[c].store(nullptr);
+    }
+    Registry(const Registry&) = delete;
+    Registry& operator=(const Registry&) = delete;
+
+    static Registry& global() {
+      static Registry registry;
+      return registry;
+    }
+
+    //! Find the entry for a named timer, creating it if needed
+    RegistryEntry& lookup(const std::string& name) {
+      std::lock_guard<std::mutex> lock(mtx);
+
+      const auto itr = byName.find(name);
+      if (itr != byName.end()) return *entries[itr->second];
+
+      const unsigned id = entries.size();
+      entries.emplace_back(new RegistryEntry(name, id, shardTable));
+      entries.back()->setFlags(flagsFor(name));
+      byName[name] = id;
+
+      if (id < NCHUNKS * CHUNK) {
+        Chunk* chunk = chunks[id / CHUNK].load(std::memory_order_relaxed);
+        if (!chunk) {
+          owned.emplace_back(chunk = new Chunk);
+          chunks[id / CHUNK].store(chunk, std::memory_order_release);
+        }
+        chunk->slots[id % CHUNK].store(entries.back().get(),
+                                       std::memory_order_release);
+      }
+      return *entries.back();
+    }
+
+    /*! Find an entry from its id
+     *
+     *  For all but very large registries, this does not lock.
+     *  An invalid id causes std::out_of_range to be thrown.
+     */
+    RegistryEntry& at(unsigned id) {
+      if (id < NCHUNKS * CHUNK) {
+        const Chunk* chunk = chunks[id / CHUNK].load(std::memory_order_acquire);
+        RegistryEntry* entry = (chunk ? chunk->slots[id % CHUNK].load(
+                                            std::memory_order_acquire)
+                                      : nullptr);
+        if (entry) return *entry;
+      }
+
+      std::lock_guard<std::mutex> lock(mtx);
+      return *entries.at(id);
+    }
+
+    //! Number of registered timers, which are numbered from zero
+    unsigned size() const {
+      std::lock_guard<std::mutex> lock(mtx);
+      return entries.size();
+    }
+
+    //! Find all entries whose names start with a given prefix
+    std::vector<RegistryEntry*> matching(const std::string& prefix) const {
+      std::vector<RegistryEntry*> found;
+      for (auto entry : list()) {
+        if (entry->name.compare(0, prefix.size(), prefix) == 0) {
+          found.push_back(entry);
+        }
+      }
+      return found;
+    }
+
+    //! Copy the statistics of all timers (whose names have a given prefix)
+    RegistrySnapshot snapshot(const std::string& prefix="") const {
+      RegistrySnapshot snap;
+      snap.taken = std::chrono::steady_clock::now();
+
+      for (auto entry : matching(prefix)) {
+        snap.timers[entry->name] = entry->read();
+      }
+      return snap;
+    }
+
+    /*! Set the flags of all timers from a list of rules
+     *
+     *  Later rules take precedence, and timers not selected by any rule
+     *  are enabled, untraced and fully sampled. The rules are kept,
+     *  and applied to timers created later.
+     */
+    void setRules(const std::vector<RegistryRule>& ruleList) {
+      std::lock_guard<std::mutex> lock(mtx);
+      rules = ruleList;
+      for (auto& entry : entries) entry->setFlags(flagsFor(entry->name));
+    }
+
+    //! Discard the statistics of all timers
+    void reset() {
+      for (auto entry : list()) entry->reset();
+    }
+
+    //! Find the changes in each timer between two snapshots
+    static RegistryDiff diff(const RegistrySnapshot& before,
+                             const RegistrySnapshot& after) {
+      RegistryDiff result;
+      result.elapsed = std::chrono::duration<double>(
+                          after.taken - before.taken).count();
+
+      for (auto& timer : after.timers) {
+        const auto prev = before.timers.find(timer.first);
+        const HistogramStats baseline = (prev != before.timers.end()
+                                          ? prev->second : HistogramStats());
+        TimerDelta delta;
+
+        delta.name = timer.first;
+        delta.interval = timer.second.since(baseline);
+        delta.baselineMean = baseline.getMean();
+        delta.ksStatistic = ksDistance(baseline, delta.interval);
+
+        const double n = baseline.count, m = delta.interval.count;
+        delta.shapeChanged = (n > 0 && m > 0
+                              && delta.ksStatistic
+                                  > 1.628 * std::sqrt((n + m) / (n * m)));
+
+        if (delta.interval.count > 0 || delta.shapeChanged) {
+          result.push_back(delta);
+        }
+      }
+
+      return result;
+    }
+
+  protected:
+    enum { CHUNK = 256, NCHUNKS = 256 };
+
+    //! Block of entries indexed by id, readable without locking
+    struct Chunk
+    {
+      Chunk() {
+        for (unsigned i=0; i<CHUNK; ++i) slots[i].store(nullptr);
+      }
+
+      std::atomic<RegistryEntry*> slots[CHUNK];
+    };
+
+    mutable std::mutex mtx;
+    ShardTable shardTable;    // Must outlive entries
+    std::vector<std::unique_ptr<RegistryEntry> > entries;
+    std::map<std::string, unsigned> byName;
+    std::atomic<Chunk*> chunks[NCHUNKS];
+    std::vector<std::unique_ptr<Chunk> > owned;
+    std::vector<RegistryRule> rules;
+
+    //! Combine the rules selecting a timer, with mtx held
+    unsigned flagsFor(const std::string& name) const {
+      RegistryRule current{ "", true, false, 0 };
+      for (auto& rule : rules) {
+        if (name.compare(0, rule.prefix.size(), rule.prefix) == 0) {
+          rule.update(current);
+        }
+      }
+      return RegistryEntry::makeFlags(current.enabled, current.traced,
+                                      current.logPeriod);
+    }
+
+    std::vector<RegistryEntry*> list() const {
+      std::lock_guard<std::mutex> lock(mtx);
+      std::vector<RegistryEntry*> all;
+      for (auto& entry : entries) all.push_back(entry.get());
+      return all;
+    }
+
+    //! Largest difference between two cumulative distributions
+    static double ksDistance(const HistogramStats& a, const HistogramStats& b) {
+      if (a.count == 0 || b.count == 0) return 0.0;
+
+      double cdfA = 0.0, cdfB = 0.0, largest = 0.0;
+      for (unsigned i=0; i<HistogramStats::NBUCKETS; ++i) {
+        cdfA += double(a.buckets[i]) / a.count;
+        cdfB += double(b.buckets[i]) / b.count;
+        largest = std::max(largest, std::fabs(cdfA - cdfB));
+      }
+      return largest;
+    }
+};
+
+
+/** Timer-statistics controller which also feeds a registry entry
+ *
+ *  This wraps another manager (e.g. SerialManager),
+ *  adding each interval to the entry of the global Registry
+ *  which has the same name as the timer.
+ *  While the entry's TRACED flag is set, ftrace begin/end records
+ *  are also written, as by ftrace::TraceMarkerManager.
+ *
+ *  \see Registry, TimerControl
+ */
+template <typename BASE>
+class RegisteredManager : public BASE
+{
+  public:
+    typedef typename BASE::Instant Instant;
+    typedef typename BASE::StatsAccumulator StatsAccumulator;
+
+    RegisteredManager()
+      : entry(NULL) {}
+
+    void setIdent(const std::string& ident) {
+      entry = &Registry::global().lookup(ident);
+
+      std::ostringstream pid;
+      pid << getpid();
+      beginRecord = "B|" + pid.str() + "|" + ident;
+      endRecord = "E|" + pid.str();
+    }
+
+    void recordStart(const Instant& now) {
+      if (entry && (entry->getFlags() & RegistryEntry::TRACED)) {
+        trace(beginRecord);
+      }
+      BASE::recordStart(now);
+    }
+
+    double updateStats(const Instant& now, StatsAccumulator& stats) {
+      const double duration = BASE::updateStats(now, stats);
+      if (entry) {
+        entry->addSample(duration);
+        if (entry->getFlags() & RegistryEntry::TRACED) trace(endRecord);
+      }
+      return duration;
+    }
+
+  protected:
+    RegistryEntry* entry;
+    std::string beginRecord;
+    std::string endRecord;
+
+    static void trace(const std::string& record) {
+      ftrace::TraceMarker& marker = ftrace::TraceMarker::global();
+      if (marker.isEnabled()) marker.write(record);
+    }
+};
+
+template <typename BASE>
+void attachIdent(RegisteredManager<BASE>& mgr, const std::string& ident) {
+  mgr.setIdent(ident);
+}
+
+
+/** Lightweight timer for a single scope, feeding a registry entry
+ *
+ *  Unlike Timer, this neither copies a name when created,
+ *  nor produces a report when destroyed, so it is cheap enough
+ *  to create for every request or task. The entry's id can be found
+ *  once (e.g. at start-up) and then shared between threads.
+ *  \code
+ *  static const unsigned reqId = Registry::global().lookup("request").id;
+ *  void handle(Request& req) {
+ *    RegistryScope<cxx11::HiResClock> scope(reqId);
+ *    ...
+ *  }
+ *  \endcode
+ */
+template <typename CLK>
+class RegistryScope
+{
+  public:
+    typedef typename CLK::Instant Instant;
+
+    explicit RegistryScope(RegistryEntry& target)
+      : entry(target), start(CLK::now()) {}
+    explicit RegistryScope(unsigned id)
+      : entry(Registry::global().at(id)), start(CLK::now()) {}
+
+    RegistryScope(const RegistryScope&) = delete;
+    RegistryScope& operator=(const RegistryScope&) = delete;
+
+    ~RegistryScope() {
+      entry.addSample(CLK::interval(start, CLK::now()));
+    }
+
+  protected:
+    RegistryEntry& entry;
+    const Instant start;
+};
+
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_REGISTRY_HPP */
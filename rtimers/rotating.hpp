@@ -0,0 +1,437 @@
+/*
+ *  Size-bounded, rotating output files written by a background thread
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_ROTATING_HPP
+#define _RTIMERS_ROTATING_HPP
+
+#if __cplusplus < 201100
+#  error "rtimers/rotating requires C++11 support"
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <dirent.h>
+#include <fcntl.h>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "core.hpp"
+#include "registry.hpp"
+
+
+namespace rtimers {
+
+
+/** Output which rotates through a bounded number of file segments
+ *
+ *  Records passed to write() are appended to an in-memory buffer,
+ *  which a background thread transfers to disk in large sequential
+ *  appends, at least every flush period. When the current segment would
+ *  exceed its size limit, or has been open longer than its age limit,
+ *  a new segment is started, and the oldest segments are deleted
+ *  so that no more than a fixed number are kept.
+ *  Segments are named by appending a sequence number to a base path,
+ *  e.g. "/var/log/app-timers.000042". Numbering continues from
+ *  any segments left by an earlier process, which are subject
+ *  to the same limit on the number kept.
+ *
+ *  After an incident, freeze() requests that all existing segments,
+ *  together with any records queued before the call, be
+ *  renamed (e.g. to "/var/log/app-timers.frozen.000042"),
+ *  which excludes them from deletion. Frozen segments are never
+ *  overwritten, even by those of a later process. It does no I/O itself,
+ *  so is safe to call from latency-sensitive code.
+ *  \code
+ *  RotatingOutput out("/var/log/app-timers", 16 << 20, 8);
+ *  out.dumpPeriodically(Registry::global(), 60.0);
+ *  RotatingLogger::setOutput(&out);
+ *  \endcode
+ */
+class RotatingOutput
+{
+  public:
+    /*! Start writing segments
+     *
+     *  \param base       Path to which sequence numbers are appended
+     *  \param maxBytes   Size limit of each segment
+     *  \param maxKeep    Number of (unfrozen) segments kept
+     *  \param maxAge     Age (in seconds) at which segments are rotated,
+     *                    or zero for no limit
+     *  \param maxBuffer  Size at which buffered records are dropped
+     */
+    RotatingOutput(const std::string& base, size_t maxBytes=16 << 20,
+                   unsigned maxKeep=8, double maxAge=0.0,
+                   size_t maxBuffer=4 << 20)
+      : basePath(base), segmentBytes(maxBytes), keep(std::max(maxKeep, 1u)),
+        segmentAge(maxAge), bufferLimit(maxBuffer),
+        period(1.0), fd(-1), sequence(0), segmentSize(0),
+        freezes(0), frozenDone(0), freezeMark(0),
+        lost(0), written(0), requested(0),
+        flushTarget(0),
+        registry(NULL), dumpInterval(0.0), running(true) {
+      resumeSequence();
+      writer = std::thread([this]() { serve(); });
+    }
+
+    RotatingOutput(const RotatingOutput&) = delete;
+    RotatingOutput& operator=(const RotatingOutput&) = delete;
+
+    ~RotatingOutput() {
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        running = false;
+      }
+      wake.notify_all();
+      writer.join();
+      if (fd >= 0) ::close(fd);
+    }
+
+    //! Queue a record (which should end in a newline) for writing
+    void write(const std::string& record) {
+      std::lock_guard<std::mutex> lock(mtx);
+
+      if (buffer.size() + record.size() > bufferLimit) {
+        ++lost;
+        return;
+      }
+      buffer += record;
+      ++requested;
+    }
+
+    //! Preserve all records queued so far, without waiting for any I/O
+    void freeze() {
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        freezeMark = buffer.size();
+        freezes.fetch_add(1, std::memory_order_release);
+      }
+      wake.notify_all();
+    }
+
+    //! Wait until all records queued so far have been written
+    void flush() {
+      std::unique_lock<std::mutex> lock(mtx);
+      const unsigned long target = requested;
+
+      flushTarget = std::max(flushTarget, target);
+      wake.notify_all();
+      done.wait(lock, [&]() {
+        return written >= target
+                && frozenDone == freezes.load(std::memory_order_acquire); });
+    }
+
+    /*! Also write the statistics of all timers in a registry periodically
+     *
+     *  \return False if the interval (in seconds) is not positive
+     */
+    bool dumpPeriodically(Registry& reg, double interval) {
+      if (!(interval > 0.0)) return false;
+
+      std::lock_guard<std::mutex> lock(mtx);
+      registry = &reg;
+      dumpInterval = interval;
+      period = std::min(period, interval);
+      return true;
+    }
+
+    //! Paths of the segments which may be deleted by rotation
+    std::vector<std::string> getSegments() const {
+      std::lock_guard<std::mutex> lock(mtx);
+      return std::vector<std::string>(segments.begin(), segments.end());
+    }
+
+    //! Paths of the segments preserved by freeze()
+    std::vector<std::string> getFrozen() const {
+      std::lock_guard<std::mutex> lock(mtx);
+      return frozen;
+    }
+
+    //! Number of records dropped because the buffer was full
+    unsigned long dropped() const {
+      std::lock_guard<std::mutex> lock(mtx);
+      return lost;
+    }
+
+  protected:
+    typedef std::chrono::steady_clock Clock;
+
+    const std::string basePath;
+    const size_t segmentBytes;
+    const unsigned keep;
+    const double segmentAge;
+    const size_t bufferLimit;
+    double period;              //!< Maximum time between writes
+
+    // State owned by the writer thread:
+    int fd;
+    unsigned long sequence;
+    size_t segmentSize;
+    Clock::time_point opened;
+    Clock::time_point lastDump;
+
+    mutable std::mutex mtx;
+    std::condition_variable wake, done;
+    std::atomic<unsigned> freezes;
+    unsigned frozenDone;
+    size_t freezeMark;          //!< Buffered bytes queued before freeze()
+    std::string buffer;
+    std::deque<std::string> segments;
+    std::vector<std::string> frozen;
+    unsigned long lost, written, requested;
+    unsigned long flushTarget;  //!< Records which flush() is waiting for
+    Registry* registry;
+    double dumpInterval;
+    bool running;
+    std::thread writer;
+
+    std::string segmentPath(unsigned long seq) const {
+      char suffix[32];
+      std::snprintf(suffix, sizeof(suffix), ".%06lu", seq);
+      return basePath + suffix;
+    }
+
+    //! Continue numbering after any segments left by an earlier process
+    void resumeSequence() {
+      const size_t slash = basePath.rfind('/');
+      const std::string dirPath = (slash == std::string::npos ? "."
+                                    : basePath.substr(0, std::max(slash,
+                                                                  size_t(1))));
+      const std::string prefix = basePath.substr(0, slash + 1);
+      const std::string stem = basePath.substr(slash + 1) + ".";
+      std::map<unsigned long, std::string> found;
+
+      DIR* dir = opendir(dirPath.c_str());
+      if (!dir) return;
+      while (const dirent* item = readdir(dir)) {
+        const std::string name(item->d_name);
+        if (name.compare(0, stem.size(), stem) != 0) continue;
+
+        std::string suffix = name.substr(stem.size());
+        const bool isFrozen = (suffix.compare(0, 7, "frozen.") == 0);
+        if (isFrozen) suffix.erase(0, 7);
+        if (suffix.empty()
+            || suffix.find_first_not_of("0123456789") != std::string::npos) {
+          continue;
+        }
+
+        const unsigned long seq = std::strtoul(suffix.c_str(), NULL, 10);
+        sequence = std::max(sequence, seq + 1);
+        if (!isFrozen) found[seq] = prefix + name;
+      }
+      closedir(dir);
+
+      for (auto& seg : found) segments.push_back(seg.second);
+      while (segments.size() > keep) {
+        ::unlink(segments.front().c_str());
+        segments.pop_front();
+      }
+    }
+
+    //! Background loop which transfers buffered records to disk
+    void serve() {
+      std::unique_lock<std::mutex> lock(mtx);
+      lastDump = Clock::now();
+
+      for (;;) {
+        wake.wait_for(lock, std::chrono::duration<double>(period), [&]() {
+          return !running || flushTarget > written
+                  || freezes.load(std::memory_order_acquire) != frozenDone; });
+
+        if (registry && dumpInterval > 0.0
+            && Clock::now() - lastDump
+                >= std::chrono::duration<double>(dumpInterval)) {
+          lastDump = Clock::now();
+          lock.unlock();
+          dumpRegistry();
+          lock.lock();
+        }
+
+        std::string pending;
+        pending.swap(buffer);
+        const size_t mark = freezeMark;
+        freezeMark = 0;
+        const unsigned long target = requested;
+        const unsigned freezeTarget = freezes.load(std::memory_order_acquire);
+        const bool stopping = !running;
+
+        lock.unlock();
+        if (freezeTarget != frozenDone) {
+          // Records queued before the freeze belong with the incident:
+          append(pending.substr(0, mark));
+          preserveSegments();
+          append(pending.substr(mark));
+        } else {
+          append(pending);
+        }
+        lock.lock();
+
+        frozenDone = freezeTarget;
+        written = target;
+        done.notify_all();
+        if (stopping) break;
+      }
+    }
+
+    void dumpRegistry() {
+      const RegistrySnapshot snap = registry->snapshot();
+      std::ostringstream strm;
+
+      for (auto& timer : snap.timers) {
+        strm << "Timer(" << timer.first << "): " << timer.second << "\n";
+      }
+      write(strm.str());
+    }
+
+    //! Write whole records, starting new segments as needed
+    void append(const std::string& pending) {
+      size_t pos = 0;
+
+      while (pos < pending.size()) {
+        if (fd < 0 || tooOld()) startSegment();
+
+        // Take as many whole records as fit within the current segment:
+        const size_t room = (segmentBytes > segmentSize
+                               ? segmentBytes - segmentSize : 0);
+        size_t len = pending.size() - pos;
+        if (len > room) {
+          const size_t cut = (room > 0 ? pending.rfind('\n', pos + room - 1)
+                                       : std::string::npos);
+          if (cut != std::string::npos && cut >= pos) {
+            len = cut + 1 - pos;
+          } else if (segmentSize > 0) {
+            startSegment();
+            continue;
+          } else {
+            // Oversized record, which is written alone:
+            const size_t end = pending.find('\n', pos);
+            len = (end != std::string::npos ? end + 1 - pos : len);
+          }
+        }
+
+        const ssize_t n = ::write(fd, pending.data() + pos, len);
+        if (n <= 0) break;
+        pos += n;
+        segmentSize += n;
+      }
+    }
+
+    bool tooOld() const {
+      return (segmentAge > 0.0 && segmentSize > 0
+              && Clock::now() - opened
+                  >= std::chrono::duration<double>(segmentAge));
+    }
+
+    void startSegment() {
+      if (fd >= 0) ::close(fd);
+
+      // Never truncate a segment, e.g. one written by another process:
+      std::string path;
+      do {
+        path = segmentPath(sequence++);
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_APPEND, 0644);
+      } while (fd < 0 && errno == EEXIST);
+      segmentSize = 0;
+      opened = Clock::now();
+      if (fd < 0) return;
+
+      std::lock_guard<std::mutex> lock(mtx);
+      segments.push_back(path);
+      while (segments.size() > keep) {
+        ::unlink(segments.front().c_str());
+        segments.pop_front();
+      }
+    }
+
+    //! Rename all current segments so that they will not be deleted
+    void preserveSegments() {
+      if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+      }
+
+      std::lock_guard<std::mutex> lock(mtx);
+      for (auto& path : segments) {
+        const std::string target = freezeSegment(path);
+        if (!target.empty()) frozen.push_back(target);
+      }
+      segments.clear();
+    }
+
+    /*! Move a segment to an unused frozen name
+     *
+     *  This links the new name before removing the old one,
+     *  which (unlike rename) fails rather than replacing an existing file.
+     *
+     *  \return The new path, or an empty string on failure
+     */
+    static std::string freezeSegment(const std::string& path) {
+      const size_t dot = path.rfind('.');
+      const std::string frozenBase = path.substr(0, dot) + ".frozen."
+                                      + path.substr(dot + 1);
+      std::string target = frozenBase;
+
+      for (unsigned attempt=1; ; ++attempt) {
+        if (::link(path.c_str(), target.c_str()) == 0) {
+          ::unlink(path.c_str());
+          return target;
+        }
+        if (errno != EEXIST) break;
+        target = frozenBase + "-" + std::to_string(attempt);
+      }
+
+      // The filesystem may not support hard links:
+      if (::access(target.c_str(), F_OK) != 0
+          && std::rename(path.c_str(), target.c_str()) == 0) return target;
+      return "";
+    }
+};
+
+
+/** Timer-statistics reporter sending reports to a RotatingOutput
+ *
+ *  \see StreamLogger
+ */
+class RotatingLogger
+{
+  public:
+    template <typename STATS>
+    static void report(const std::string& ident, const STATS& stats) {
+      RotatingOutput* out = output().load(std::memory_order_acquire);
+      if (!out) return;
+
+      std::ostringstream strm;
+      strm << "Timer(" << ident << "): " << stats << "\n";
+      out->write(strm.str());
+    }
+
+    static void setOutput(RotatingOutput* out) {
+      output().store(out, std::memory_order_release);
+    }
+
+  protected:
+    static std::atomic<RotatingOutput*>& output() {
+      static std::atomic<RotatingOutput*> out(nullptr);
+      return out;
+    }
+};
+
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_ROTATING_HPP */
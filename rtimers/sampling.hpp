@@ -0,0 +1,426 @@
+/*
+ *  SIGPROF sampling profiler attributing samples to active timer scopes
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_SAMPLING_HPP
+#define _RTIMERS_SAMPLING_HPP
+
+#if __cplusplus < 201100
+#  error "rtimers/sampling requires C++11 support"
+#endif
+#if !defined(__linux)
+#  error "rtimers/sampling requires Linux per-thread timers"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <set>
+#include <signal.h>
+#include <sstream>
+#include <sys/syscall.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <vector>
+
+#include "core.hpp"
+#include "symbols.hpp"
+
+
+namespace rtimers {
+  namespace sampling {
+
+
+/** Per-thread stack of currently active timer scopes
+ *
+ *  This is written only by its own thread, and read by that thread's
+ *  signal handler, so needs only compiler barriers, not atomics.
+ */
+struct ScopeStack
+{
+  enum { MAXDEPTH = 64 };
+
+  const std::string* scopes[MAXDEPTH];
+  unsigned depth;
+
+  static ScopeStack& local() {
+    static thread_local ScopeStack stack = { { NULL }, 0 };
+    return stack;
+  }
+
+  //! Find a persistent copy of a scope label, which outlives its timer
+  static const std::string* intern(const std::string& label) {
+    static std::mutex mtx;
+    static std::set<std::string> labels;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    return &*labels.insert(label).first;
+  }
+
+  void push(const std::string* label) {
+    if (depth < MAXDEPTH) scopes[depth] = label;
+    std::atomic_signal_fence(std::memory_order_release);
+    ++depth;
+  }
+
+  /*! Remove a scope, which need not be the innermost one
+   *
+   *  Timers may be stopped in any order, so the innermost entry
+   *  with the given label is removed, and any inside it moved outwards.
+   *  A label which is not on the stack is ignored, unless the stack
+   *  has overflowed, in which case it may be one that wasn't stored.
+   */
+  void pop(const std::string* label) {
+    if (depth == 0) return;
+
+    const unsigned stored = std::min<unsigned>(depth, MAXDEPTH);
+    unsigned pos = stored;
+    while (pos > 0 && scopes[pos - 1] != label) --pos;
+
+    if (depth <= MAXDEPTH) {
+      if (pos == 0) return;
+      for (unsigned i=pos; i<stored; ++i) scopes[i - 1] = scopes[i];
+    }
+    std::atomic_signal_fence(std::memory_order_release);
+    --depth;
+    std::atomic_signal_fence(std::memory_order_release);
+  }
+
+  //! The innermost active scope, or NULL if none is active
+  const std::string* top() const {
+    const unsigned d = depth;
+    std::atomic_signal_fence(std::memory_order_acquire);
+    if (d == 0) return NULL;
+    return scopes[std::min<unsigned>(d, MAXDEPTH) - 1];
+  }
+};
+
+
+/** Timer-statistics controller which maintains the stack of active scopes
+ *
+ *  This wraps another manager (e.g. SerialManager), so that
+ *  a SamplingProfiler can attribute samples to the innermost
+ *  timer which is running in the interrupted thread.
+ *
+ *  \see SamplingProfiler
+ */
+template <typename BASE>
+class ScopeStackManager : public BASE
+{
+  public:
+    typedef typename BASE::Instant Instant;
+    typedef typename BASE::StatsAccumulator StatsAccumulator;
+
+    ScopeStackManager()
+      : label(NULL) {}
+
+    void setIdent(const std::string& ident) {
+      label = ScopeStack::intern(ident);
+    }
+
+    void recordStart(const Instant& now) {
+      ScopeStack::local().push(label);
+      BASE::recordStart(now);
+    }
+
+    double updateStats(const Instant& now, StatsAccumulator& stats) {
+      const double duration = BASE::updateStats(now, stats);
+      ScopeStack::local().pop(label);
+      return duration;
+    }
+
+  protected:
+    const std::string* label;
+};
+
+template <typename BASE>
+void attachIdent(ScopeStackManager<BASE>& mgr, const std::string& ident) {
+  mgr.setIdent(ident);
+}
+
+
+//! Number of samples observed in one function within a timer scope
+struct HotSpot
+{
+  std::string location;       //!< Function containing sampled addresses
+  unsigned long samples;
+};
+
+
+//! Breakdown of samples taken within a single timer scope
+struct ScopeProfile
+{
+  unsigned long samples;
+  std::vector<HotSpot> hotspots;    //!< In order of decreasing frequency
+};
+
+inline std::ostream& operator<<(std::ostream& os, const ScopeProfile& prof) {
+  os << "samples = " << prof.samples;
+
+  for (size_t i=0; i<prof.hotspots.size(); ++i) {
+    os << (i > 0 ? ", " : ": ") << prof.hotspots[i].location << " ("
+       << (100 * prof.hotspots[i].samples / std::max(prof.samples, 1ul))
+       << "%)";
+  }
+  return os;
+}
+
+
+/** Statistical profiler driven by per-thread CPU-time timers
+ *
+ *  Each thread to be profiled should call attachThread(), which creates
+ *  a timer delivering SIGPROF at a configured rate of consumed CPU time.
+ *  The signal handler records the innermost scope of any timer
+ *  based on ScopeStackManager, together with the interrupted
+ *  program counter, in a fixed-size lock-free table.
+ *  Program counters are only symbolised, and aggregated by function,
+ *  when reports are generated.
+ *  \code
+ *  typedef Timer<ScopeStackManager<SerialManager<cxx11::HiResClock,
+ *                                                VarBoundStats> >,
+ *                StderrLogger> ProfiledTimer;
+ *  SamplingProfiler::start(200);
+ *  SamplingProfiler::attachThread();
+ *  ...
+ *  SamplingProfiler::report();
+ *  \endcode
+ */
+class SamplingProfiler
+{
+  public:
+    //! Install the SIGPROF handler, with a given sampling rate (in Hz)
+    static bool start(double rate=97.0) {
+      if (!(rate > 0.0)) return false;
+
+      State& st = state();
+      if (!st.installed) {
+        struct sigaction action;
+        action.sa_sigaction = handler;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, &st.previous) != 0) return false;
+        st.installed = true;
+      }
+
+      st.period = 1.0 / rate;
+      st.active.store(true);
+      return true;
+    }
+
+    /*! Stop recording samples, and restore any previous SIGPROF handler
+     *
+     *  Threads should detach before this is called,
+     *  so that they are not sent SIGPROF after the handler is removed.
+     */
+    static void stop() {
+      State& st = state();
+
+      st.active.store(false);
+      st.period = 0.0;
+      if (st.installed) {
+        sigaction(SIGPROF, &st.previous, NULL);
+        st.installed = false;
+      }
+    }
+
+    /*! Start sampling the calling thread's CPU time
+     *
+     *  \return False if the profiler has not been started,
+     *           or a timer could not be created
+     */
+    static bool attachThread() {
+      timer_t& tmr = threadTimer();
+      if (threadAttached()) return true;
+
+      const double period = state().period;
+      if (!(period > 0.0)) return false;
+
+      struct sigevent sev;
+      sev.sigev_notify = SIGEV_THREAD_ID;
+      sev.sigev_signo = SIGPROF;
+#if defined(sigev_notify_thread_id)
+      sev.sigev_notify_thread_id = syscall(SYS_gettid);
+#else
+      sev._sigev_un._tid = syscall(SYS_gettid);
+#endif
+      if (timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &tmr) != 0) return false;
+
+      struct itimerspec spec;
+      spec.it_interval.tv_sec = (time_t)period;
+      spec.it_interval.tv_nsec = (long)((period - spec.it_interval.tv_sec) * 1e9);
+      spec.it_value = spec.it_interval;
+      timer_settime(tmr, 0, &spec, NULL);
+
+      threadAttached() = true;
+      return true;
+    }
+
+    //! Stop sampling the calling thread
+    static void detachThread() {
+      if (!threadAttached()) return;
+
+      timer_delete(threadTimer());
+      threadAttached() = false;
+    }
+
+    //! Number of samples taken outside any timer scope
+    static unsigned long unattributed() {
+      return state().unscoped.load(std::memory_order_relaxed);
+    }
+
+    //! Number of samples lost because the table was full
+    static unsigned long dropped() {
+      return state().overflow.load(std::memory_order_relaxed);
+    }
+
+    //! Gather per-scope hot-spots, keeping at most 'top' per scope
+    static std::map<std::string, ScopeProfile> collect(unsigned top=5) {
+      std::map<const std::string*, std::map<std::string, unsigned long> > raw;
+      State& st = state();
+
+      for (unsigned i=0; i<TABLESIZE; ++i) {
+        const Slot& slot = st.table[i];
+        if (slot.status.load(std::memory_order_acquire) != FILLED) continue;
+
+        std::map<std::string, unsigned long>& locations = raw[slot.scope];
+        const void* pc = reinterpret_cast<const void*>(slot.pc);
+        locations[symbolise(pc)] += slot.count.load(std::memory_order_relaxed);
+      }
+
+      std::map<std::string, ScopeProfile> profiles;
+      for (auto& scope : raw) {
+        ScopeProfile& prof = profiles[*scope.first];
+        prof.samples = 0;
+        for (auto& loc : scope.second) {
+          prof.samples += loc.second;
+          prof.hotspots.push_back(HotSpot{ loc.first, loc.second });
+        }
+        std::sort(prof.hotspots.begin(), prof.hotspots.end(),
+                  [](const HotSpot& a, const HotSpot& b) {
+                    return a.samples > b.samples; });
+        if (prof.hotspots.size() > top) prof.hotspots.resize(top);
+      }
+
+      return profiles;
+    }
+
+    //! Report per-scope hot-spots via a timer logger
+    template <typename LOG=StderrLogger>
+    static void report(unsigned top=5) {
+      const std::map<std::string, ScopeProfile> profiles = collect(top);
+
+      for (auto& prof : profiles) {
+        LOG::report(prof.first, prof.second);
+      }
+    }
+
+    //! Discard all samples (not safe while sampling is active)
+    static void reset() {
+      State& st = state();
+
+      for (unsigned i=0; i<TABLESIZE; ++i) {
+        st.table[i].count.store(0);
+        st.table[i].status.store(EMPTY);
+      }
+      st.unscoped.store(0);
+      st.overflow.store(0);
+    }
+
+  protected:
+    enum { TABLESIZE = 4096 };
+    enum { EMPTY = 0, CLAIMED = 1, FILLED = 2 };
+
+    struct Slot {
+      std::atomic<int> status;
+      const std::string* scope;
+      uintptr_t pc;
+      std::atomic<unsigned long> count;
+    };
+
+    struct State {
+      std::atomic<bool> active;
+      double period;
+      bool installed;               //!< Whether our SIGPROF handler is set
+      struct sigaction previous;    //!< Handler to restore when stopping
+      std::atomic<unsigned long> unscoped;
+      std::atomic<unsigned long> overflow;
+      Slot table[TABLESIZE];
+    };
+
+    static State& state() {
+      static State st;
+      return st;
+    }
+
+    static timer_t& threadTimer() {
+      static thread_local timer_t tmr;
+      return tmr;
+    }
+
+    static bool& threadAttached() {
+      static thread_local bool attached = false;
+      return attached;
+    }
+
+    static uintptr_t interruptedPC(void* context) {
+      const ucontext_t* uc = static_cast<const ucontext_t*>(context);
+#if defined(__x86_64__)
+      return uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__aarch64__)
+      return uc->uc_mcontext.pc;
+#else
+      return 0;
+#endif
+    }
+
+    static void handler(int sig, siginfo_t* info, void* context) {
+      State& st = state();
+      if (!st.active.load(std::memory_order_relaxed)) return;
+
+      const std::string* scope = ScopeStack::local().top();
+      if (!scope) {
+        st.unscoped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+
+      const uintptr_t pc = interruptedPC(context);
+      const uintptr_t hash = ((reinterpret_cast<uintptr_t>(scope) >> 3) ^ pc)
+                              * 0x9e3779b97f4a7c15ull;
+
+      for (unsigned probe=0; probe<TABLESIZE; ++probe) {
+        Slot& slot = st.table[((hash >> 40) + probe) % TABLESIZE];
+        int status = slot.status.load(std::memory_order_acquire);
+
+        if (status == EMPTY
+            && slot.status.compare_exchange_strong(status, CLAIMED)) {
+          slot.scope = scope;
+          slot.pc = pc;
+          slot.count.store(1, std::memory_order_relaxed);
+          slot.status.store(FILLED, std::memory_order_release);
+          return;
+        }
+        if (status == FILLED && slot.scope == scope && slot.pc == pc) {
+          slot.count.fetch_add(1, std::memory_order_relaxed);
+          return;
+        }
+      }
+
+      st.overflow.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+
+  }   // namespace sampling
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_SAMPLING_HPP */
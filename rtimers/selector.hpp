@@ -0,0 +1,246 @@
+/*
+ *  Run-time selection between alternative implementations
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_SELECTOR_HPP
+#define _RTIMERS_SELECTOR_HPP
+
+#if __cplusplus < 201100
+#  error "rtimers/selector requires C++11 support"
+#endif
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "core.hpp"
+
+
+namespace rtimers {
+
+template <typename SIG, typename CLK> class Selector;
+
+
+/** Choose the fastest of several implementations of a function
+ *
+ *  Candidate implementations are called via plain function pointers,
+ *  and their timings are gathered separately for each size class
+ *  (i.e. power of two) of a client-supplied problem size.
+ *  Initially, each candidate is timed a few times in turn,
+ *  after which calls are dispatched to the candidate with the shortest
+ *  geometric-mean time. Periodically, a call is timed again,
+ *  with the candidate chosen by an epsilon-greedy or
+ *  upper-confidence-bound strategy applied to log(time),
+ *  so that decisions are re-validated as conditions change.
+ *  Untimed calls cost a counter decrement and one indirect call.
+ *  Candidates may be added at any time, and each new candidate
+ *  is explored before any decision depends on its timings.
+ *
+ *  A Selector is not thread-safe, so each thread should have its own.
+ *  \code
+ *  Selector<void(char*, const char*, size_t),
+ *           cxx11::HiResClock> copier;
+ *  copier.add("bytewise", copyBytes);
+ *  copier.add("vector", copyVector);
+ *  ...
+ *  copier(n, dst, src, n);
+ *  \endcode
+ *
+ *  \see LogBoundStats
+ */
+template <typename CLK, typename R, typename... ARGS>
+class Selector<R(ARGS...), CLK>
+{
+  public:
+    typedef R (*Function)(ARGS...);
+
+    enum Strategy { EPSILON_GREEDY, UCB };
+    enum { NCLASSES = 48 };
+
+    Selector(Strategy strat=UCB, unsigned explorations=8,
+             unsigned revalidation=64, double eps=0.1)
+      : strategy(strat), explore(explorations), interval(revalidation),
+        epsilon(eps), rng(5489u) {}
+
+    /*! Register an alternative implementation
+     *
+     *  \return False if the function pointer is null
+     */
+    bool add(const std::string& name, Function fn) {
+      if (!fn) return false;
+
+      names.push_back(name);
+      functions.push_back(fn);
+      for (auto& cls : classes) {
+        cls.stats.push_back(LogBoundStats());
+        cls.countdown = 0;        // Time the next call, to explore 'fn'
+      }
+      return true;
+    }
+
+    /*! Call the preferred implementation for a given problem size
+     *
+     *  This throws std::logic_error if no implementations have been added.
+     */
+    R operator()(size_t size, ARGS... args) {
+      SizeClass& cls = classes[sizeClass(size)];
+      if (functions.empty()) {
+        throw std::logic_error("rtimers::Selector has no implementations");
+      }
+
+      if (--cls.countdown > 0) {
+        return cls.chosen(args...);
+      }
+
+      const unsigned arm = pickArm(cls);
+      Stopwatch watch(*this, cls, arm);
+      return functions[arm](args...);
+    }
+
+    //! Index of the implementation currently preferred for a problem size
+    unsigned choice(size_t size) const {
+      return classes[sizeClass(size)].best;
+    }
+
+    //! Timing statistics of one implementation for a problem size
+    const LogBoundStats& getStats(size_t size, unsigned arm) const {
+      return classes[sizeClass(size)].stats[arm];
+    }
+
+    const std::string& getName(unsigned arm) const {
+      return names[arm];
+    }
+
+    static unsigned sizeClass(size_t size) {
+      unsigned cls = 0;
+      while (size > 1 && cls < (NCLASSES - 1)) {
+        size >>= 1;
+        ++cls;
+      }
+      return cls;
+    }
+
+    //! Report preferred implementations and their timings by size class
+    template <typename LOG=StderrLogger>
+    void report(const std::string& ident) const {
+      for (unsigned c=0; c<NCLASSES; ++c) {
+        const SizeClass& cls = classes[c];
+        if (cls.timed == 0) continue;
+
+        for (unsigned arm=0; arm<names.size(); ++arm) {
+          LOG::report(ident + "[" + std::to_string(1ul << c) + "]/"
+                        + names[arm] + (arm == cls.best ? "*" : ""),
+                      cls.stats[arm]);
+        }
+      }
+    }
+
+  protected:
+    struct SizeClass {
+      SizeClass()
+        : chosen(nullptr), countdown(0), best(0), timed(0) {}
+
+      Function chosen;
+      long countdown;           //!< Untimed calls before the next timed one
+      unsigned best;
+      unsigned long timed;
+      std::vector<LogBoundStats> stats;
+    };
+
+    //! Time a call, and update the preferred implementation when done
+    struct Stopwatch {
+      Stopwatch(Selector& sel, SizeClass& cls, unsigned arm)
+        : selector(sel), sizeClass(cls), index(arm), start(CLK::now()) {}
+      ~Stopwatch() {
+        const double dt = CLK::interval(start, CLK::now());
+        selector.record(sizeClass, index, dt);
+      }
+
+      Selector& selector;
+      SizeClass& sizeClass;
+      const unsigned index;
+      const typename CLK::Instant start;
+    };
+
+    const Strategy strategy;
+    const unsigned explore;
+    const unsigned interval;
+    const double epsilon;
+    std::minstd_rand rng;
+    std::vector<std::string> names;
+    std::vector<Function> functions;
+    SizeClass classes[NCLASSES];
+
+    //! Find the implementation which has been timed least often
+    static unsigned leastTimed(const SizeClass& cls) {
+      unsigned arm = 0;
+      for (unsigned i=1; i<cls.stats.size(); ++i) {
+        if (cls.stats[i].count < cls.stats[arm].count) arm = i;
+      }
+      return arm;
+    }
+
+    //! Check whether any implementation still needs exploring
+    bool exploring(const SizeClass& cls) const {
+      const unsigned long least = cls.stats[leastTimed(cls)].count;
+      return (least == 0 || least < explore);
+    }
+
+    unsigned pickArm(const SizeClass& cls) {
+      const unsigned arms = functions.size();
+
+      // Explore all implementations, including any added later, in turn:
+      if (exploring(cls)) return leastTimed(cls);
+
+      if (strategy == EPSILON_GREEDY) {
+        std::uniform_real_distribution<double> coin(0.0, 1.0);
+        if (coin(rng) >= epsilon) return cls.best;
+        std::uniform_int_distribution<unsigned> any(0, arms - 1);
+        return any(rng);
+      }
+
+      // Minimize a lower confidence bound on mean log(time):
+      const double logN = std::log(double(cls.timed));
+      unsigned arm = 0;
+      double lowest = 1e18;
+      for (unsigned i=0; i<arms; ++i) {
+        const LogBoundStats& st = cls.stats[i];
+        const double spread = std::max(std::sqrt(st.nLogVariance / st.count),
+                                       0.01);
+        const double bound = st.logMean
+                              - spread * std::sqrt(2.0 * logN / st.count);
+        if (bound < lowest) {
+          lowest = bound;
+          arm = i;
+        }
+      }
+      return arm;
+    }
+
+    void record(SizeClass& cls, unsigned arm, double dt) {
+      cls.stats[arm].addSample(dt);
+      ++cls.timed;
+
+      for (unsigned i=0; i<functions.size(); ++i) {
+        if (cls.stats[i].count > 0
+            && cls.stats[i].logMean < cls.stats[cls.best].logMean) {
+          cls.best = i;
+        }
+      }
+      if (cls.stats[cls.best].count == 0) cls.best = arm;
+
+      cls.chosen = functions[cls.best];
+      cls.countdown = (exploring(cls) ? 1 : interval);
+    }
+};
+
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_SELECTOR_HPP */
@@ -0,0 +1,231 @@
+/*
+ *  Per-thread statistics shards placed on the local NUMA node
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_SHARDS_HPP
+#define _RTIMERS_SHARDS_HPP
+
+#if __cplusplus < 201100
+#  error "rtimers/shards requires C++11 support"
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+#if defined(__linux)
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+
+namespace rtimers {
+  namespace numa {
+
+/** Find the NUMA node of the CPU on which the calling thread is running
+ *
+ *  This returns zero if the node cannot be determined.
+ */
+inline int currentNode() {
+#if defined(__linux) && defined(SYS_getcpu)
+  unsigned cpu = 0, node = 0;
+  if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0) return node;
+#endif
+  return 0;
+}
+
+
+/** Find the NUMA node on which a page of memory has been placed
+ *
+ *  \return The node, or -1 if this cannot be determined
+ */
+inline int nodeOfAddress(const void* addr) {
+#if defined(__linux) && defined(SYS_get_mempolicy)
+  enum { MPOL_F_NODE = 1 << 0, MPOL_F_ADDR = 1 << 1 };
+  int node = -1;
+  if (syscall(SYS_get_mempolicy, &node, NULL, 0,
+              addr, MPOL_F_NODE | MPOL_F_ADDR) == 0) return node;
+#endif
+  return -1;
+}
+
+
+/** Request that a range of pages be placed on a given NUMA node
+ *
+ *  This must be applied before the pages are first touched.
+ */
+inline bool preferNode(void* addr, size_t len, int node) {
+#if defined(__linux) && defined(SYS_mbind)
+  enum { MPOL_PREFERRED = 1 };
+  unsigned long mask[16] = { 0 };
+  const unsigned bits = 8 * sizeof(unsigned long);
+
+  if (node < 0 || unsigned(node) >= 16 * bits) return false;
+  mask[node / bits] = 1ul << (node % bits);
+  return syscall(SYS_mbind, addr, len, MPOL_PREFERRED,
+                 mask, 16 * bits, 0) == 0;
+#else
+  return false;
+#endif
+}
+
+
+/** Spare memory, on known NUMA nodes, awaiting reuse by any thread
+ *
+ *  This collects the unused tails of the chunks of threads which
+ *  have exited, and blocks released when statistics are destroyed.
+ *  Spans are never merged, because almost all blocks have the same size.
+ */
+class SparePool
+{
+  public:
+    struct Span
+    {
+      char* base;
+      size_t size;
+      int node;
+    };
+
+    static SparePool& global() {
+      // Never destroyed, so that threads may exit during shutdown:
+      static SparePool* pool = new SparePool;
+      return *pool;
+    }
+
+    void give(void* base, size_t size, int node) {
+      if (!base || size == 0) return;
+      std::lock_guard<std::mutex> lock(mtx);
+      spans.push_back(Span{ static_cast<char*>(base), size, node });
+    }
+
+    //! Claim the smallest span on a given node which is large enough
+    bool take(size_t size, int node, Span& found) {
+      std::lock_guard<std::mutex> lock(mtx);
+      std::vector<Span>::iterator best = spans.end();
+
+      for (auto itr=spans.begin(); itr!=spans.end(); ++itr) {
+        if (itr->node != node || itr->size < size) continue;
+        if (best == spans.end() || itr->size < best->size) best = itr;
+      }
+      if (best == spans.end()) return false;
+
+      found = *best;
+      *best = spans.back();
+      spans.pop_back();
+      return true;
+    }
+
+  protected:
+    std::mutex mtx;
+    std::vector<Span> spans;
+};
+
+
+/** Per-thread allocator of memory on the thread's local NUMA node
+ *
+ *  Memory is obtained in chunks, each of which is bound to the node
+ *  on which the thread is running, and then zeroed by that thread,
+ *  so that first-touch placement also puts it there.
+ *  The node actually holding each chunk is then checked.
+ *  Memory is never returned to the system, so that statistics
+ *  can outlive their threads, but blocks passed to release(),
+ *  and the unused remainder of each thread's chunk when it exits,
+ *  are recycled via the SparePool.
+ */
+class LocalArena
+{
+  public:
+    enum { CHUNK = 1 << 16, ALIGN = 64 };
+
+    static LocalArena& local() {
+      static thread_local LocalArena arena;
+      return arena;
+    }
+
+    ~LocalArena() {
+      retire();
+    }
+
+    //! Allocate cache-line aligned memory, returning its node via 'where'
+    void* allocate(size_t size, int& where) {
+      size = roundUp(size);
+      if (!chunk || used + size > limit) newChunk(size);
+
+      void* block = chunk + used;
+      used += size;
+      where = node;
+      return block;
+    }
+
+    //! Return a block from allocate(), from any thread, for reuse
+    static void release(void* block, size_t size, int node) {
+      SparePool::global().give(block, roundUp(size), node);
+    }
+
+  protected:
+    LocalArena()
+      : chunk(NULL), used(0), limit(0), node(0) {}
+
+    char* chunk;
+    size_t used;
+    size_t limit;
+    int node;
+
+    static size_t roundUp(size_t size) {
+      return (size + ALIGN - 1) & ~size_t(ALIGN - 1);
+    }
+
+    //! Pass the unused remainder of the current chunk to the spare pool
+    void retire() {
+      if (chunk && used < limit) {
+        SparePool::global().give(chunk + used, limit - used, node);
+      }
+      chunk = NULL;
+      used = limit = 0;
+    }
+
+    void newChunk(size_t size) {
+      retire();
+
+      const int wanted = currentNode();
+      SparePool::Span spare;
+      if (SparePool::global().take(size, wanted, spare)) {
+        chunk = spare.base;
+        limit = spare.size;
+        node = spare.node;
+        return;
+      }
+
+      const size_t len = std::max(size, size_t(CHUNK));
+      void* mem = NULL;
+
+#if defined(__linux)
+      mem = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (mem == MAP_FAILED) mem = NULL;
+      if (mem) preferNode(mem, len, wanted);
+#endif
+      if (!mem && posix_memalign(&mem, ALIGN, len) != 0) throw std::bad_alloc();
+
+      std::memset(mem, 0, len);
+      chunk = static_cast<char*>(mem);
+      limit = len;
+
+      const int actual = nodeOfAddress(chunk);
+      node = (actual >= 0 ? actual : wanted);
+    }
+};
+
+  }   // namespace numa
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_SHARDS_HPP */
@@ -0,0 +1,289 @@
+/*
+ *  Detection of process-wide stalls via a heartbeat thread
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_STALL_HPP
+#define _RTIMERS_STALL_HPP
+
+#if __cplusplus < 201100
+#  error "rtimers/stall requires C++11 support"
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core.hpp"
+#include "ftrace.hpp"
+
+
+namespace rtimers {
+
+
+/** Heartbeat thread which detects stalls affecting the whole process
+ *
+ *  The heartbeat repeatedly sleeps for a short period, and records
+ *  how late it wakes up. Host CPU steal, memory compaction or swapping
+ *  will delay the heartbeat as much as any other thread, so any wake-up
+ *  later than a threshold is recorded as a process-wide stall.
+ *  Timer outliers can then be compared against these stalls
+ *  to distinguish environmental delays from slow client code.
+ *  Each stall is also written to the ftrace trace_marker, when enabled,
+ *  as a counter record ("C|pid|rtimers.stall_us|lateness") followed by
+ *  a reset to zero, so that it appears alongside timers' begin/end records.
+ *  Because a stall is only detected once the heartbeat wakes, and the
+ *  kernel timestamps each record as it is written, this spike marks
+ *  the end of the stall, which began "lateness" microseconds earlier;
+ *  trace_marker records alone cannot draw a slice covering it.
+ *
+ *  \see StallFlaggedStats, ftrace::TraceMarker
+ */
+class StallDetector
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+    using Instant = Clock::time_point;
+
+    //! Interval during which the heartbeat was unable to run
+    struct Stall {
+      Instant start;
+      Instant end;
+    };
+
+    StallDetector()
+      : running(false), lastBeat(0), period(1e-3), threshold(2e-3),
+        stallCount(0) {
+      std::ostringstream pfx;
+      pfx << "C|" << getpid() << "|rtimers.stall_us|";
+      tracePrefix = pfx.str();
+    }
+    StallDetector(const StallDetector&) = delete;
+    StallDetector& operator=(const StallDetector&) = delete;
+    ~StallDetector() {
+      stop();
+    }
+
+    //! The process-wide detector consulted by StallFlaggedStats
+    static StallDetector& global() {
+      static StallDetector detector;
+      return detector;
+    }
+
+    /*! Start the heartbeat thread
+     *
+     *  \param interval The heartbeat sleep period (in seconds)
+     *  \param limit The wake-up lateness above which a stall is recorded
+     */
+    void start(double interval=1e-3, double limit=2e-3) {
+      if (running.exchange(true)) return;
+
+      period = interval;
+      threshold = limit;
+      heartbeat = std::thread(&StallDetector::beat, this);
+    }
+
+    //! Stop and join the heartbeat thread
+    void stop() {
+      if (!running.exchange(false)) return;
+
+      heartbeat.join();
+    }
+
+    bool isRunning() const {
+      return running;
+    }
+
+    //! Record the time at which the heartbeat woke, relative to expectation
+    void noteWakeup(const Instant& expected, const Instant& actual) {
+      const double late = std::chrono::duration<double>(actual - expected).count();
+
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        lateness.addSample(late);
+        if (late > threshold) {
+          stalls.push_back(Stall{ expected, actual });
+          if (stalls.size() > maxStalls) stalls.pop_front();
+          ++stallCount;
+        }
+      }
+
+      if (late > threshold) traceStall(late);
+
+      lastBeat.store(actual.time_since_epoch().count());
+    }
+
+    //! Check whether the heartbeat has woken since a given time
+    bool hasCovered(const Instant& when) const {
+      return lastBeat.load() >= when.time_since_epoch().count();
+    }
+
+    //! Check whether an interval overlaps any recently recorded stall
+    bool overlapsStall(const Instant& start, const Instant& end) const {
+      std::lock_guard<std::mutex> lock(mtx);
+
+      for (const Stall& st : stalls) {
+        if (st.start < end && start < st.end) return true;
+      }
+      return false;
+    }
+
+    //! Get statistics of heartbeat wake-up lateness
+    VarBoundStats getLateness() const {
+      std::lock_guard<std::mutex> lock(mtx);
+      return lateness;
+    }
+
+    //! Get the total number of stalls detected
+    unsigned long getStallCount() const {
+      std::lock_guard<std::mutex> lock(mtx);
+      return stallCount;
+    }
+
+  protected:
+    //! Maximum number of stalls retained for overlap checks
+    static const size_t maxStalls = 256;
+
+    std::thread heartbeat;
+    std::atomic<bool> running;
+    std::atomic<Clock::rep> lastBeat;
+    double period;
+    double threshold;
+
+    mutable std::mutex mtx;
+    VarBoundStats lateness;
+    std::deque<Stall> stalls;
+    unsigned long stallCount;
+    std::string tracePrefix;    //!< Start of trace_marker counter records
+
+    //! Write a counter spike, at the end of the stall, giving its length
+    void traceStall(double late) {
+      ftrace::TraceMarker& marker = ftrace::TraceMarker::global();
+      if (!marker.isEnabled()) return;
+
+      std::ostringstream strm;
+      strm << tracePrefix << (unsigned long)(late * 1e6 + 0.5);
+      marker.write(strm.str());
+      marker.write(tracePrefix + "0");
+    }
+
+    void beat() {
+      const auto sleep = std::chrono::duration_cast<Clock::duration>(
+                              std::chrono::duration<double>(period));
+
+      while (running) {
+        const Instant expected = Clock::now() + sleep;
+        std::this_thread::sleep_until(expected);
+        noteWakeup(expected, Clock::now());
+      }
+    }
+};
+
+
+/** Wrapper around timer statistics which flags outliers caused by stalls
+ *
+ *  Samples much longer than the running mean are treated as outliers,
+ *  and their approximate time-span is compared against stalls recorded
+ *  by StallDetector::global(). Only outliers pay for a clock reading,
+ *  and comparisons are deferred until the heartbeat has woken
+ *  after each outlier, so that the stall covering it has been recorded.
+ *
+ *  \see StallDetector
+ */
+template <typename STATS=VarBoundStats>
+struct StallFlaggedStats : public STATS
+{
+  typedef StallDetector::Instant Instant;
+
+  StallFlaggedStats()
+    : outliers(0), stalledOutliers(0), refCount(0), refMean(0.0) {}
+
+  void addSample(double dt) {
+    STATS::addSample(dt);
+
+    if (refCount >= minReference && dt > outlierFactor * refMean) {
+      noteOutlier(dt);
+    } else {
+      ++refCount;
+      refMean += (dt - refMean) / refCount;
+    }
+
+    if (!pending.empty()) resolve(false);
+  }
+
+  //! Count outliers which overlapped a stall, including unresolved ones
+  unsigned long countStalled() const {
+    const StallDetector& detector = StallDetector::global();
+    unsigned long total = stalledOutliers;
+
+    for (const Span& sp : pending) {
+      if (detector.overlapsStall(sp.start, sp.end)) ++total;
+    }
+    return total;
+  }
+
+  unsigned long outliers;         //!< Number of outlying samples
+  unsigned long stalledOutliers;  //!< Resolved outliers during stalls
+
+  protected:
+    struct Span {
+      Instant start;
+      Instant end;
+    };
+
+    static const unsigned long minReference = 16;
+    static const size_t maxPending = 64;
+    static constexpr double outlierFactor = 4.0;
+
+    unsigned long refCount;
+    double refMean;
+    std::vector<Span> pending;
+
+    void noteOutlier(double dt) {
+      const Instant end = StallDetector::Clock::now();
+      const auto span = std::chrono::duration_cast<StallDetector::Clock::duration>(
+                              std::chrono::duration<double>(dt));
+
+      ++outliers;
+      if (pending.size() >= maxPending) resolve(true);
+      pending.push_back(Span{ end - span, end });
+    }
+
+    void resolve(bool force) {
+      const StallDetector& detector = StallDetector::global();
+      size_t kept = 0;
+
+      for (size_t i=0; i<pending.size(); ++i) {
+        const Span& sp = pending[i];
+        if (force || detector.hasCovered(sp.end)) {
+          if (detector.overlapsStall(sp.start, sp.end)) ++stalledOutliers;
+        } else {
+          pending[kept++] = sp;
+        }
+      }
+      pending.resize(kept);
+    }
+};
+
+template <typename STATS>
+std::ostream& operator<<(std::ostream& os,
+                         const StallFlaggedStats<STATS>& stats) {
+  os << static_cast<const STATS&>(stats)
+     << ", outliers = " << stats.outliers
+     << " (" << stats.countStalled() << " during stalls)";
+  return os;
+}
+
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_STALL_HPP */
@@ -0,0 +1,296 @@
+/*
+ *  Timeline of process start-up phases
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_STARTUP_HPP
+#define _RTIMERS_STARTUP_HPP
+
+#if __cplusplus < 201100
+#  error "rtimers/startup requires C++11 support"
+#endif
+#if !defined(__linux)
+#  error "rtimers/startup requires Linux /proc and dl_iterate_phdr()"
+#endif
+
+#include <cstdlib>
+#include <dlfcn.h>
+#include <fstream>
+#include <link.h>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "core.hpp"
+#include "registry.hpp"
+
+
+namespace rtimers {
+
+
+/** Record of the time taken to reach successive start-up milestones
+ *
+ *  Times are measured from the kernel's record of when the process
+ *  was created (from /proc/self/stat, with a resolution of one clock tick,
+ *  typically 10ms), so include the time spent by the dynamic loader.
+ *  A "static-init" milestone is recorded automatically when the first
+ *  translation unit including this header is statically initialized,
+ *  and client code can mark further milestones, such as "main",
+ *  "config loaded" or "first request served".
+ *  At each milestone, shared libraries which have been loaded since
+ *  the previous milestone are noted, together with the time spent
+ *  loading them via loadLibrary(). The libraries noted at "static-init"
+ *  are those loaded before main() by the dynamic loader, whose time
+ *  cannot be separated from the rest of the interval since exec,
+ *  which is dominated by the loader in programs with many libraries.
+ *  The interval leading up to each milestone is also added to
+ *  a registered timer named "startup.<milestone>", and the duration
+ *  of each loadLibrary() to "startup.dlopen".
+ *  A timeline is reported when the first milestone named "ready"
+ *  is marked, or by the first call to markReady().
+ *  \code
+ *  int main() {
+ *    rtimers::StartupProfiler::global().mark("main");
+ *    loadConfig();
+ *    rtimers::StartupProfiler::global().mark("config loaded");
+ *    openSockets();
+ *    rtimers::StartupProfiler::global().markReady();
+ *  }
+ *  \endcode
+ */
+class StartupProfiler
+{
+  public:
+    struct Milestone {
+      std::string name;
+      double time;                          //!< Seconds since process creation
+      std::vector<std::string> libraries;   //!< Shared objects newly loaded
+      unsigned long librarySize;            //!< Bytes mapped by those objects
+      double loadTime;                      //!< Seconds in loadLibrary()
+    };
+
+    explicit StartupProfiler(Registry& reg=Registry::global())
+      : registry(reg), execTime(processStartTime()), reported(false),
+        pendingLoad(0.0) {}
+    StartupProfiler(const StartupProfiler&) = delete;
+    StartupProfiler& operator=(const StartupProfiler&) = delete;
+
+    static StartupProfiler& global();
+
+    //! Time since boot at which this process was created (in seconds)
+    static double processStartTime() {
+      std::ifstream strm("/proc/self/stat");
+      std::string stat;
+      std::getline(strm, stat);
+
+      // Skip the command name, which may contain spaces:
+      const size_t close = stat.rfind(')');
+      if (close == std::string::npos) return 0.0;
+      std::istringstream fields(stat.substr(close + 2));
+
+      // starttime is the 22nd field, and the 20th after the command name:
+      std::string field;
+      for (unsigned i=0; i<20 && (fields >> field); ++i) {}
+      const double ticks = std::strtod(field.c_str(), NULL);
+
+      return ticks / sysconf(_SC_CLK_TCK);
+    }
+
+    //! Current time since boot (in seconds)
+    static double bootTime() {
+      timespec t;
+      clock_gettime(CLOCK_BOOTTIME, &t);
+      return t.tv_sec + 1e-9 * t.tv_nsec;
+    }
+
+    //! Time elapsed since this process was created
+    double sinceExec() const {
+      return bootTime() - execTime;
+    }
+
+    /*! Record the time at which a named milestone has been reached
+     *
+     *  If this is the first milestone named "ready",
+     *  the timeline is also reported.
+     */
+    template <typename LOG=StderrLogger>
+    void mark(const std::string& name) {
+      record(name);
+      if (name == "ready") reportOnce<LOG>();
+    }
+
+    /*! Load a shared library via dlopen(), timing how long that takes
+     *
+     *  The time is attributed to the next milestone to be marked.
+     */
+    void* loadLibrary(const std::string& file, int flags=RTLD_NOW) {
+      const double start = bootTime();
+      void* handle = dlopen(file.c_str(), flags);
+      const double dt = bootTime() - start;
+
+      { std::lock_guard<std::mutex> lock(mtx);
+        pendingLoad += dt;
+      }
+      registry.lookup("startup.dlopen").addSample(dt);
+
+      return handle;
+    }
+
+    /*! Mark a milestone, and report the timeline if not yet reported
+     *
+     *  \return True if the timeline was reported by this call
+     */
+    template <typename LOG=StderrLogger>
+    bool markReady(const std::string& name="ready") {
+      record(name);
+      return reportOnce<LOG>();
+    }
+
+    //! Get a copy of all milestones recorded so far
+    std::vector<Milestone> getMilestones() const {
+      std::lock_guard<std::mutex> lock(mtx);
+      return milestones;
+    }
+
+  protected:
+    struct LibraryScan {
+      std::set<std::string>* known;
+      Milestone* milestone;
+    };
+
+    Registry& registry;
+    const double execTime;
+    bool reported;
+    mutable std::mutex mtx;
+    std::vector<Milestone> milestones;
+    std::set<std::string> libraries;
+    double pendingLoad;         //!< Time in loadLibrary() since last milestone
+
+    void record(const std::string& name) {
+      const double now = sinceExec();
+      double delta;
+
+      { std::lock_guard<std::mutex> lock(mtx);
+        Milestone ms;
+        ms.name = name;
+        ms.time = now;
+        ms.librarySize = 0;
+        ms.loadTime = pendingLoad;
+        pendingLoad = 0.0;
+
+        LibraryScan scan = { &libraries, &ms };
+        dl_iterate_phdr(noteLibrary, &scan);
+
+        delta = now - (milestones.empty() ? 0.0 : milestones.back().time);
+        milestones.push_back(ms);
+      }
+
+      registry.lookup("startup." + name).addSample(delta);
+    }
+
+    //! Report the timeline, unless this has already been done
+    template <typename LOG>
+    bool reportOnce() {
+      { std::lock_guard<std::mutex> lock(mtx);
+        if (reported) return false;
+        reported = true;
+      }
+
+      LOG::report("startup", *this);
+      return true;
+    }
+
+    static int noteLibrary(dl_phdr_info* info, size_t size, void* data) {
+      LibraryScan* scan = static_cast<LibraryScan*>(data);
+      const std::string name = (info->dlpi_name && info->dlpi_name[0]
+                                  ? info->dlpi_name : "[main]");
+
+      if (scan->known->insert(name).second) {
+        scan->milestone->libraries.push_back(name);
+        for (unsigned i=0; i<info->dlpi_phnum; ++i) {
+          if (info->dlpi_phdr[i].p_type == PT_LOAD) {
+            scan->milestone->librarySize += info->dlpi_phdr[i].p_memsz;
+          }
+        }
+      }
+      return 0;
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& os,
+                                const StartupProfiler& profiler) {
+  const std::vector<StartupProfiler::Milestone> milestones =
+                                                  profiler.getMilestones();
+  double previous = 0.0;
+
+  os << "exec";
+  for (size_t i=0; i<milestones.size(); ++i) {
+    const StartupProfiler::Milestone& ms = milestones[i];
+    const double delta = ms.time - previous;
+    const TimeUnit tu = BoundStats::guessUnit(delta);
+
+    os << " -> " << ms.name << " +" << (delta * tu.mult) << tu.unit;
+    if (!ms.libraries.empty() || ms.loadTime > 0.0) {
+      const TimeUnit ltu = BoundStats::guessUnit(ms.loadTime);
+      os << " [" << ms.libraries.size() << " libs, "
+         << (ms.librarySize >> 10) << "kB";
+      if (ms.loadTime > 0.0) {
+        os << ", load " << (ms.loadTime * ltu.mult) << ltu.unit;
+      }
+      if (ms.libraries.size() <= 3) {
+        for (size_t j=0; j<ms.libraries.size(); ++j) {
+          os << (j > 0 ? ", " : ": ") << ms.libraries[j];
+        }
+      }
+      os << "]";
+    }
+    previous = ms.time;
+  }
+
+  const TimeUnit tu = BoundStats::guessUnit(previous);
+  os << " (total " << (previous * tu.mult) << tu.unit << ")";
+
+  return os;
+}
+
+
+/** Record the moment at which static initialization reaches rtimers
+ *
+ *  As a static member of a class template, this is initialized only once
+ *  per program, however many translation units include this header,
+ *  provided that StartupProfiler::global() is used somewhere.
+ */
+template <typename T=void>
+struct StartupStaticInit
+{
+  static const bool marked;
+
+  static bool mark() {
+    StartupProfiler& profiler = StartupProfiler::global();
+    if (profiler.getMilestones().empty()) profiler.mark("static-init");
+    return true;
+  }
+};
+
+template <typename T>
+const bool StartupStaticInit<T>::marked = StartupStaticInit<T>::mark();
+
+
+inline StartupProfiler& StartupProfiler::global() {
+  static StartupProfiler profiler;
+  (void)&StartupStaticInit<>::marked;
+  return profiler;
+}
+
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_STARTUP_HPP */
@@ -0,0 +1,51 @@
+/*
+ *  Symbolic names of functions, for reporting per-function statistics
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_SYMBOLS_HPP
+#define _RTIMERS_SYMBOLS_HPP
+
+#include <cstdlib>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <sstream>
+#include <string>
+
+
+namespace rtimers {
+
+
+//! Convert a mangled symbol into a readable name, if possible
+inline std::string demangle(const char* symbol) {
+  int status = -1;
+  char* demangled = abi::__cxa_demangle(symbol, NULL, NULL, &status);
+  const std::string name = (status == 0 ? demangled : symbol);
+  std::free(demangled);
+  return name;
+}
+
+
+/*! Find the (demangled) name of the function containing an address
+ *
+ *  Only exported symbols can be found, so executables should be linked
+ *  with -rdynamic. Otherwise, the address is returned in hexadecimal.
+ */
+inline std::string symbolise(const void* addr) {
+  Dl_info info;
+
+  if (dladdr(addr, &info) && info.dli_sname) return demangle(info.dli_sname);
+
+  std::ostringstream hex;
+  hex << addr;
+  return hex.str();
+}
+
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_SYMBOLS_HPP */
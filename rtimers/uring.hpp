@@ -0,0 +1,440 @@
+/*
+ *  Submission-to-completion latency of io_uring operations
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_URING_HPP
+#define _RTIMERS_URING_HPP
+
+#if __cplusplus < 201100
+#  error "rtimers/uring requires C++11 support"
+#endif
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <map>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+#include "core.hpp"
+
+
+namespace rtimers {
+
+
+//! Outcome of one operation submitted through a TimedUring
+struct UringCompletion
+{
+  uint64_t tag;           //!< Value supplied by the caller when preparing
+  int32_t result;         //!< Result from the kernel, e.g. bytes or -errno
+  uint8_t opcode;
+  double latency;         //!< Time from submission to completion (seconds)
+};
+
+
+/** Latency bookkeeping for operations submitted through any io_uring
+ *
+ *  This allows rings managed elsewhere (e.g. by liburing, or polled by
+ *  a kernel thread via IORING_SETUP_SQPOLL) to be timed.
+ *  Each submission entry is passed to stamp() once fully prepared,
+ *  but before it is made visible to the kernel (e.g. by io_uring_submit()),
+ *  which records the time and replaces its user_data with an index
+ *  into a table of stamps. Each completion is then passed to complete(),
+ *  which adds the operation's latency to per-opcode statistics,
+ *  and returns the caller's original user_data as the completion's tag.
+ *  The number of operations in flight is sampled as each is stamped.
+ *  Like an io_uring itself, this should be used by only one thread.
+ *  \code
+ *  UringTimer<cxx11::HiResClock> timing;
+ *  io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+ *  io_uring_prep_read(sqe, fd, buff, len, 0);
+ *  io_uring_sqe_set_data64(sqe, myTag);
+ *  timing.stamp(sqe);
+ *  io_uring_submit(&ring);
+ *  ...
+ *  UringCompletion done;
+ *  if (timing.complete(cqe, done)) handle(done.tag, done.result);
+ *  \endcode
+ */
+template <typename CLK, typename STATS=MeanBoundStats>
+class UringTimer
+{
+  public:
+    typedef typename CLK::Instant Instant;
+
+    UringTimer()
+      : flying(0) {}
+
+    //! Note the submission time of an operation, taking over its user_data
+    void stamp(io_uring_sqe* sqe) {
+      uint64_t idx;
+      if (freeSlots.empty()) {
+        idx = slots.size();
+        slots.push_back(Slot());
+      } else {
+        idx = freeSlots.back();
+        freeSlots.pop_back();
+      }
+
+      Slot& slot = slots[idx];
+      slot.tag = sqe->user_data;
+      slot.opcode = sqe->opcode;
+      sqe->user_data = idx;
+      depth.addSample(++flying);
+      slot.start = CLK::now();
+    }
+
+    /*! Find the latency of a completed operation
+     *
+     *  \return False if the completion does not match any stamped operation
+     */
+    bool complete(const io_uring_cqe* cqe, UringCompletion& done) {
+      const Instant now = CLK::now();
+      if (cqe->user_data >= slots.size()) return false;
+      const Slot& slot = slots[cqe->user_data];
+
+      done.tag = slot.tag;
+      done.result = cqe->res;
+      done.opcode = slot.opcode;
+      done.latency = CLK::interval(slot.start, now);
+      addTimedSample(opStats[slot.opcode], done.latency, now);
+
+      freeSlots.push_back(cqe->user_data);
+      --flying;
+      return true;
+    }
+
+    //! Number of operations stamped but not yet completed
+    unsigned inFlight() const {
+      return flying;
+    }
+
+    //! Latency statistics of each opcode which has completed
+    const std::map<uint8_t, STATS>& getStats() const {
+      return opStats;
+    }
+
+    //! Number of operations in flight, sampled as each is stamped
+    const VarBoundStats& getDepth() const {
+      return depth;
+    }
+
+    //! Report latency of each opcode, and queue depth, via a timer logger
+    template <typename LOG=StderrLogger>
+    void report(const std::string& prefix="uring") const {
+      for (auto& op : opStats) {
+        LOG::report(prefix + "." + opName(op.first), op.second);
+      }
+      LOG::report(prefix + ".depth", depth);
+    }
+
+    static std::string opName(uint8_t opcode) {
+      switch (opcode) {
+        case IORING_OP_NOP:     return "nop";
+        case IORING_OP_READV:   return "readv";
+        case IORING_OP_WRITEV:  return "writev";
+        case IORING_OP_FSYNC:   return "fsync";
+        case IORING_OP_READ:    return "read";
+        case IORING_OP_WRITE:   return "write";
+        default:                break;
+      }
+      std::ostringstream strm;
+      strm << "op" << unsigned(opcode);
+      return strm.str();
+    }
+
+  protected:
+    //! Timestamp and caller's tag of an operation, indexed by user_data
+    struct Slot
+    {
+      Instant start;
+      uint64_t tag;
+      uint8_t opcode;
+    };
+
+    unsigned flying;
+    std::vector<Slot> slots;
+    std::vector<uint64_t> freeSlots;
+
+    std::map<uint8_t, STATS> opStats;
+    VarBoundStats depth;
+};
+
+
+/** Minimal io_uring instance which times each operation
+ *
+ *  Operations are prepared via read(), write(), fsync() or prepare(),
+ *  and passed to the kernel by submit(), at which time each is stamped
+ *  by a UringTimer. Completions are collected via wait() or poll(),
+ *  which add each operation's latency to per-opcode statistics,
+ *  and return the caller's own tag in place of user_data.
+ *  This uses raw system calls, so does not require liburing,
+ *  and (like an io_uring itself) should be used by only one thread.
+ *  Rings created by other means can be timed via UringTimer directly.
+ *  \code
+ *  TimedUring<cxx11::HiResClock> ring(64);
+ *  ring.write(fd, buff, len, 0);
+ *  ring.fsync(fd);
+ *  ring.submit();
+ *  UringCompletion done;
+ *  while (ring.inFlight() > 0 && ring.wait(done)) { ... }
+ *  ring.report("storage");
+ *  \endcode
+ */
+template <typename CLK, typename STATS=MeanBoundStats>
+class TimedUring
+{
+  public:
+    typedef typename CLK::Instant Instant;
+
+    explicit TimedUring(unsigned entries=64)
+      : ringFd(-1), sqRing(NULL), cqRing(NULL), sqes(NULL),
+        sqRingSize(0), cqRingSize(0), sqesSize(0),
+        localTail(0), pending(0), unstamped(0), flying(0) {
+      io_uring_params params;
+      std::memset(&params, 0, sizeof(params));
+
+      ringFd = int(syscall(__NR_io_uring_setup, entries, &params));
+      if (ringFd < 0) return;
+      if (!mapRings(params)) {
+        release();
+        return;
+      }
+    }
+
+    TimedUring(const TimedUring&) = delete;
+    TimedUring& operator=(const TimedUring&) = delete;
+
+    ~TimedUring() {
+      release();
+    }
+
+    //! Check whether the kernel supports io_uring, and the ring was created
+    bool isReady() const {
+      return ringFd >= 0;
+    }
+
+    bool read(int fd, void* buff, unsigned len, uint64_t offset,
+              uint64_t tag=0) {
+      io_uring_sqe* sqe = prepare(IORING_OP_READ, tag);
+      if (!sqe) return false;
+      sqe->fd = fd;
+      sqe->addr = reinterpret_cast<uintptr_t>(buff);
+      sqe->len = len;
+      sqe->off = offset;
+      return true;
+    }
+
+    bool write(int fd, const void* buff, unsigned len, uint64_t offset,
+               uint64_t tag=0) {
+      io_uring_sqe* sqe = prepare(IORING_OP_WRITE, tag);
+      if (!sqe) return false;
+      sqe->fd = fd;
+      sqe->addr = reinterpret_cast<uintptr_t>(buff);
+      sqe->len = len;
+      sqe->off = offset;
+      return true;
+    }
+
+    bool fsync(int fd, uint64_t tag=0) {
+      io_uring_sqe* sqe = prepare(IORING_OP_FSYNC, tag);
+      if (!sqe) return false;
+      sqe->fd = fd;
+      return true;
+    }
+
+    /*! Reserve a submission entry, for the caller to complete
+     *
+     *  The caller may set any field except user_data,
+     *  which is replaced by the tag.
+     *
+     *  \return NULL if the submission queue is full
+     */
+    io_uring_sqe* prepare(uint8_t opcode, uint64_t tag=0) {
+      if (!isReady()) return NULL;
+
+      const unsigned head = loadAcquire(sqHead);
+      if (localTail - head >= *sqEntries) return NULL;
+
+      const unsigned idx = localTail & *sqMask;
+      io_uring_sqe* sqe = sqes + idx;
+      std::memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = opcode;
+      sqe->user_data = tag;
+      sqArray[idx] = idx;
+      ++localTail;
+      ++pending;
+      ++unstamped;
+      return sqe;
+    }
+
+    //! Pass all prepared operations to the kernel, returning how many
+    int submit() {
+      if (pending == 0) return 0;
+
+      // Stamp each new operation just before the kernel can see it:
+      for (unsigned i=unstamped; i>0; --i) {
+        timing.stamp(sqes + ((localTail - i) & *sqMask));
+      }
+      unstamped = 0;
+      storeRelease(sqTail, localTail);
+
+      const int n = int(syscall(__NR_io_uring_enter, ringFd, pending,
+                                0, 0, NULL, 0));
+      if (n > 0) {
+        pending -= n;
+        flying += n;
+      }
+      return n;
+    }
+
+    //! Collect one completion, waiting for it if necessary
+    bool wait(UringCompletion& done) {
+      while (isReady()) {
+        if (poll(done)) return true;
+        if (flying == 0) return false;
+
+        const int n = int(syscall(__NR_io_uring_enter, ringFd, 0, 1,
+                                  IORING_ENTER_GETEVENTS, NULL, 0));
+        if (n < 0 && errno != EINTR) return false;
+      }
+      return false;
+    }
+
+    //! Collect one completion, if any is available
+    bool poll(UringCompletion& done) {
+      if (!isReady()) return false;
+
+      const unsigned head = *cqHead;
+      if (head == loadAcquire(cqTail)) return false;
+
+      timing.complete(cqes + (head & *cqMask), done);
+      --flying;
+      storeRelease(cqHead, head + 1);
+      return true;
+    }
+
+    //! Number of operations submitted but not yet collected
+    unsigned inFlight() const {
+      return flying;
+    }
+
+    //! Latency statistics of each opcode which has completed
+    const std::map<uint8_t, STATS>& getStats() const {
+      return timing.getStats();
+    }
+
+    //! Number of operations in flight, sampled as each is submitted
+    const VarBoundStats& getDepth() const {
+      return timing.getDepth();
+    }
+
+    //! Report latency of each opcode, and queue depth, via a timer logger
+    template <typename LOG=StderrLogger>
+    void report(const std::string& prefix="uring") const {
+      timing.template report<LOG>(prefix);
+    }
+
+    static std::string opName(uint8_t opcode) {
+      return UringTimer<CLK, STATS>::opName(opcode);
+    }
+
+  protected:
+    int ringFd;
+    void* sqRing;
+    void* cqRing;
+    io_uring_sqe* sqes;
+    size_t sqRingSize, cqRingSize, sqesSize;
+
+    unsigned *sqHead, *sqTail, *sqMask, *sqEntries, *sqArray;
+    unsigned *cqHead, *cqTail, *cqMask;
+    io_uring_cqe* cqes;
+
+    unsigned localTail;         //!< Submission tail, including unsubmitted
+    unsigned pending;           //!< Prepared but not yet submitted
+    unsigned unstamped;         //!< Prepared but not yet seen by submit()
+    unsigned flying;
+    UringTimer<CLK, STATS> timing;
+
+    bool mapRings(const io_uring_params& params) {
+      sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+      cqRingSize = params.cq_off.cqes
+                    + params.cq_entries * sizeof(io_uring_cqe);
+      const bool single = (params.features & IORING_FEAT_SINGLE_MMAP);
+      if (single) sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+
+      sqRing = mmap(NULL, sqRingSize, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+      if (sqRing == MAP_FAILED) {
+        sqRing = NULL;
+        return false;
+      }
+      if (single) {
+        cqRing = sqRing;
+      } else {
+        cqRing = mmap(NULL, cqRingSize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+          cqRing = NULL;
+          return false;
+        }
+      }
+
+      sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+      void* mem = mmap(NULL, sqesSize, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+      if (mem == MAP_FAILED) return false;
+      sqes = static_cast<io_uring_sqe*>(mem);
+
+      char* sq = static_cast<char*>(sqRing);
+      sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+      sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+      sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+      sqEntries = reinterpret_cast<unsigned*>(sq
+                                              + params.sq_off.ring_entries);
+      sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+      char* cq = static_cast<char*>(cqRing);
+      cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+      cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+      cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+      cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+      localTail = *sqTail;
+      return true;
+    }
+
+    void release() {
+      if (sqes) munmap(sqes, sqesSize);
+      if (cqRing && cqRing != sqRing) munmap(cqRing, cqRingSize);
+      if (sqRing) munmap(sqRing, sqRingSize);
+      if (ringFd >= 0) ::close(ringFd);
+      sqes = NULL;
+      sqRing = cqRing = NULL;
+      ringFd = -1;
+    }
+
+    // Ring indices are shared with the kernel, so need ordered access:
+    static unsigned loadAcquire(const unsigned* ptr) {
+      return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+    }
+
+    static void storeRelease(unsigned* ptr, unsigned value) {
+      __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+    }
+};
+
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_URING_HPP */
@@ -0,0 +1,123 @@
+/*
+ *  User-level statically-defined tracing (USDT) probes for timers
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*  When RTIMERS_HAVE_USDT is defined to be non-zero, Timer::start()
+ *  and Timer::stop() contain SystemTap-compatible probe points,
+ *  visible to tools such as bpftrace, perf-probe or SystemTap as:
+ *    rtimers:timer_start(id, name)
+ *    rtimers:timer_stop(id, name, duration_ns)
+ *  where "id" is the address of the Timer, and "name" is a pointer
+ *  to its C-string identifier. Each probe is guarded by a semaphore
+ *  which is only non-zero while a tracer is attached, so that unattached
+ *  probes cost a single load and branch, with no argument preparation.
+ *
+ *  The probe notes are emitted directly, in the same layout
+ *  as <sys/sdt.h>, so that the SystemTap headers are not required.
+ */
+
+#ifndef _RTIMERS_USDT_HPP
+#define _RTIMERS_USDT_HPP
+
+#if !defined(RTIMERS_HAVE_USDT)
+#  define RTIMERS_HAVE_USDT 0
+#endif
+
+#if RTIMERS_HAVE_USDT && !(defined(__ELF__) \
+                           && (defined(__x86_64__) || defined(__aarch64__)))
+#  error "rtimers USDT probes require an ELF target on x86_64 or aarch64"
+#endif
+
+
+#if RTIMERS_HAVE_USDT
+
+extern "C" {
+__extension__ unsigned short rtimers_timer_start_semaphore
+    __attribute__((weak, visibility("hidden"), section(".probes"))) = 0;
+__extension__ unsigned short rtimers_timer_stop_semaphore
+    __attribute__((weak, visibility("hidden"), section(".probes"))) = 0;
+}
+
+#define RTIMERS_USDT_NOTE(probe, argfmt) \
+  "990: nop\n" \
+  ".pushsection .note.stapsdt,\"?\",\"note\"\n" \
+  ".balign 4\n" \
+  ".4byte 992f-991f, 994f-993f, 3\n" \
+  "991: .asciz \"stapsdt\"\n" \
+  "992: .balign 4\n" \
+  "993: .8byte 990b\n" \
+  ".8byte _.stapsdt.base\n" \
+  ".8byte rtimers_" #probe "_semaphore\n" \
+  ".asciz \"rtimers\"\n" \
+  ".asciz \"" #probe "\"\n" \
+  ".asciz \"" argfmt "\"\n" \
+  "994: .balign 4\n" \
+  ".popsection\n" \
+  ".ifndef _.stapsdt.base\n" \
+  ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+  ".weak _.stapsdt.base\n" \
+  ".hidden _.stapsdt.base\n" \
+  "_.stapsdt.base: .space 1\n" \
+  ".size _.stapsdt.base, 1\n" \
+  ".popsection\n" \
+  ".endif\n"
+
+#define RTIMERS_PROBE_TIMER_START(id, name) \
+  do { \
+    if (__builtin_expect(rtimers_timer_start_semaphore != 0, 0)) { \
+      __asm__ __volatile__(RTIMERS_USDT_NOTE(timer_start, "8@%0 8@%1") \
+          : : "r"((unsigned long)(id)), \
+              "r"((unsigned long)((name).c_str()))); \
+    } \
+  } while (0)
+
+#define RTIMERS_PROBE_TIMER_STOP(id, name, dt) \
+  do { \
+    if (__builtin_expect(rtimers_timer_stop_semaphore != 0, 0)) { \
+      __asm__ __volatile__(RTIMERS_USDT_NOTE(timer_stop, "8@%0 8@%1 -8@%2") \
+          : : "r"((unsigned long)(id)), \
+              "r"((unsigned long)((name).c_str())), \
+              "r"((long)((dt) * 1e9))); \
+    } \
+  } while (0)
+
+namespace rtimers {
+  namespace usdt {
+
+/** Interval reported by a manager's updateStats(), if it returns one
+ *
+ *  This is the right-hand operand of a comma expression, so that
+ *  a manager returning a double replaces it via operator,(),
+ *  while one returning void leaves it as zero.
+ */
+struct Duration
+{
+  Duration()
+    : seconds(0.0) {}
+
+  double seconds;
+};
+
+inline Duration operator,(double dt, Duration d) {
+  d.seconds = dt;
+  return d;
+}
+
+  }   // namespace usdt
+}   // namespace rtimers
+
+#else   // !RTIMERS_HAVE_USDT
+
+#define RTIMERS_PROBE_TIMER_START(id, name) ((void)(id), (void)(name))
+#define RTIMERS_PROBE_TIMER_STOP(id, name, dt) \
+  ((void)(id), (void)(name), (void)(dt))
+
+#endif  // RTIMERS_HAVE_USDT
+
+#endif  /* !_RTIMERS_USDT_HPP */
@@ -0,0 +1,125 @@
+/*
+ *  Separation of cold-start and steady-state timing statistics
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef _RTIMERS_WARMUP_HPP
+#define _RTIMERS_WARMUP_HPP
+
+#include "core.hpp"
+
+
+namespace rtimers {
+
+
+/** Accumulate cold-start and steady-state statistics separately
+ *
+ *  The first calls to a function are often distorted by page faults,
+ *  cold caches or lazy initialization. This wrapper directs samples
+ *  into a cold-start accumulator until steady state is detected,
+ *  and into a steady-state accumulator thereafter.
+ *
+ *  If WARMUP is non-zero, steady state begins after exactly that
+ *  many samples. Otherwise, samples are grouped into windows
+ *  of WINDOW samples (at least two), and steady state begins once
+ *  the mean of a window is consistent with that of its predecessor,
+ *  i.e. differs by less than two standard errors, or by less than 5%.
+ *  Warm-up is assumed to have ended after MAXWINDOWS windows regardless.
+ *
+ *  \see VarBoundStats
+ */
+template <typename STATS=VarBoundStats, unsigned WARMUP=0,
+          unsigned WINDOW=32, unsigned MAXWINDOWS=64>
+struct WarmupStats
+{
+  // Each window's variance needs at least two samples:
+  static_assert(WINDOW >= 2,
+                "rtimers::WarmupStats needs at least two samples per window");
+
+  WarmupStats()
+    : count(0), steady(false), windows(0),
+      winCount(0), winMean(0.0), winVariance(0.0),
+      prevMean(0.0), prevVariance(0.0) {}
+
+  void addSample(double dt) {
+    ++count;
+
+    if (steady) {
+      steadyState.addSample(dt);
+      return;
+    }
+
+    coldStart.addSample(dt);
+
+    if (WARMUP > 0) {
+      steady = (coldStart.count >= WARMUP);
+    } else {
+      addToWindow(dt);
+    }
+  }
+
+  //! Check whether warm-up has been completed
+  bool isSteady() const {
+    return steady;
+  }
+
+  unsigned long count;    //!< Total number of samples
+  STATS coldStart;        //!< Samples taken during warm-up
+  STATS steadyState;      //!< Samples taken after warm-up
+
+  protected:
+    bool steady;
+    unsigned windows;
+    unsigned winCount;
+    double winMean;
+    double winVariance;   //!< Sum of squared deviations within window
+    double prevMean;
+    double prevVariance;  //!< Variance of the previous window
+
+    void addToWindow(double dt) {
+      ++winCount;
+      const double delta = dt - winMean;
+      winMean += delta / winCount;
+      winVariance += delta * (dt - winMean);
+
+      if (winCount < WINDOW) return;
+
+      const double variance = winVariance / (winCount - 1);
+      ++windows;
+
+      if (windows > 1) {
+        const double diff = std::fabs(winMean - prevMean);
+        const double stdErr = std::sqrt((variance + prevVariance) / WINDOW);
+
+        steady = (diff <= 2.0 * stdErr || diff <= 0.05 * prevMean
+                  || windows >= MAXWINDOWS);
+      }
+
+      prevMean = winMean;
+      prevVariance = variance;
+      winCount = 0;
+      winMean = winVariance = 0.0;
+    }
+};
+
+template <typename STATS, unsigned WARMUP, unsigned WINDOW, unsigned MAXWINDOWS>
+std::ostream& operator<<(std::ostream& os,
+                         const WarmupStats<STATS, WARMUP,
+                                           WINDOW, MAXWINDOWS>& stats) {
+  if (stats.isSteady()) {
+    os << "steady: " << stats.steadyState << "; "
+       << "cold-start: " << stats.coldStart;
+  } else {
+    os << "warming-up: " << stats.coldStart;
+  }
+  return os;
+}
+
+}   // namespace rtimers
+
+#endif  /* !_RTIMERS_WARMUP_HPP */
@@ -0,0 +1,36 @@
+/*
+ *  Command-line client for querying an rtimers::StatsEndpoint
+ *  e.g. "rtquery /run/myapp/timers.sock stats db."
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <iostream>
+#include <rtimers/endpoint.hpp>
+
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " SOCKET REQUEST [PREFIX]" << std::endl
+              << "  where REQUEST is one of:"
+              << " list, stats, reset, enable, disable" << std::endl;
+    return 1;
+  }
+
+  std::string request(argv[2]);
+  for (int i=3; i<argc; ++i) request += std::string(" ") + argv[i];
+
+  std::string response;
+  if (!rtimers::StatsEndpoint::query(argv[1], request, response)) {
+    std::cerr << "Cannot contact endpoint at " << argv[1] << std::endl;
+    return 2;
+  }
+
+  std::cout << response;
+  return (response.compare(0, 6, "error:") == 0 ? 3 : 0);
+}
@@ -0,0 +1,212 @@
+/*
+ *  Benchmark of node-local versus remote placement of registry shards
+ *  e.g. "numactl --cpunodebind=0 --membind=1 shardbench 8",
+ *  where the heap-allocated shards follow the --membind policy,
+ *  but the arena-allocated shards stay on each thread's node,
+ *  together with the full cost of RegistryEntry::addSample()
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <thread>
+#include <time.h>
+#include <vector>
+#include <rtimers/registry.hpp>
+
+using namespace rtimers;
+
+
+//! Timings of one placement strategy
+struct Outcome
+{
+  double perSample;           //!< CPU time per sample, within each thread
+  double merge;               //!< Seconds to merge all shards
+  std::set<int> shardNodes;   //!< NUMA nodes holding the shards
+  std::set<int> threadNodes;  //!< NUMA nodes on which threads ran
+};
+
+
+//! CPU time consumed by the calling thread (in seconds)
+double threadTime()
+{
+  timespec t;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+  return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+
+//! Intervals spread across several histogram buckets
+inline double fakeInterval(unsigned long i)
+{
+  return 1e-6 * (1 + (i * 7919) % 97);
+}
+
+
+/*! Time the work done by RegistryEntry::addSample() on each thread's shard
+ *
+ *  \param shards  Per-thread shards, or NULL for each thread
+ *                  to allocate its own, as RegistryEntry does
+ */
+Outcome run(std::vector<RegistryShard*>& shards, unsigned long samples)
+{
+  Outcome out;
+  const unsigned nthreads = shards.size();
+  std::vector<std::thread> threads;
+  std::vector<double> cpu(nthreads);
+  std::vector<int> nodes(nthreads);
+
+  for (unsigned t=0; t<nthreads; ++t) {
+    threads.push_back(std::thread([&, t]() {
+      if (!shards[t]) {
+        int node = 0;
+        void* mem = numa::LocalArena::local().allocate(sizeof(RegistryShard),
+                                                       node);
+        shards[t] = new (mem) RegistryShard;
+        shards[t]->node = node;
+      }
+      RegistryShard& shard = *shards[t];
+
+      const double start = threadTime();
+      for (unsigned long i=0; i<samples; ++i) {
+        shard.add(fakeInterval(i));
+      }
+      cpu[t] = threadTime() - start;
+      nodes[t] = numa::currentNode();
+    }));
+  }
+  for (auto& thr : threads) thr.join();
+
+  out.perSample = 0.0;
+  for (unsigned t=0; t<nthreads; ++t) out.perSample += cpu[t] / samples;
+  out.perSample /= nthreads;
+
+  const std::chrono::steady_clock::time_point merging =
+                                          std::chrono::steady_clock::now();
+  HistogramStats total;
+  for (auto shard : shards) total += shard->read();
+  out.merge = std::chrono::duration<double>(
+                  std::chrono::steady_clock::now() - merging).count();
+
+  for (auto shard : shards) out.shardNodes.insert(numa::nodeOfAddress(shard));
+  out.threadNodes.insert(nodes.begin(), nodes.end());
+  return out;
+}
+
+
+/*! Shards placed by each thread's LocalArena
+ *
+ *  These are bound to each thread's own node, whatever the process
+ *  memory policy, as are the shards of a RegistryEntry.
+ */
+Outcome runLocal(unsigned nthreads, unsigned long samples)
+{
+  std::vector<RegistryShard*> shards(nthreads, NULL);
+  const Outcome out = run(shards, samples);
+
+  for (auto shard : shards) {
+    const int node = shard->node;
+    shard->~RegistryShard();
+    numa::LocalArena::release(shard, sizeof(RegistryShard), node);
+  }
+  return out;
+}
+
+
+/*! Shards allocated on the heap by the main thread
+ *
+ *  These follow the process memory policy (e.g. from numactl --membind),
+ *  or are placed by the main thread's first touch.
+ */
+Outcome runHeap(unsigned nthreads, unsigned long samples)
+{
+  std::vector<RegistryShard*> shards;
+  for (unsigned t=0; t<nthreads; ++t) shards.push_back(new RegistryShard);
+
+  const Outcome out = run(shards, samples);
+
+  for (auto shard : shards) delete shard;
+  return out;
+}
+
+
+/*! Time RegistryEntry::addSample(), as called by RegistryScope
+ *
+ *  This includes finding each thread's shard and checking the entry's
+ *  flags, as well as updating the shard.
+ */
+double runEntry(unsigned nthreads, unsigned long samples)
+{
+  Registry registry;
+  RegistryEntry& entry = registry.lookup("bench");
+  std::vector<std::thread> threads;
+  std::vector<double> cpu(nthreads);
+
+  for (unsigned t=0; t<nthreads; ++t) {
+    threads.push_back(std::thread([&, t]() {
+      entry.addSample(fakeInterval(0));
+
+      const double start = threadTime();
+      for (unsigned long i=0; i<samples; ++i) {
+        entry.addSample(fakeInterval(i));
+      }
+      cpu[t] = threadTime() - start;
+    }));
+  }
+  for (auto& thr : threads) thr.join();
+
+  double perSample = 0.0;
+  for (unsigned t=0; t<nthreads; ++t) perSample += cpu[t] / samples;
+  return perSample / nthreads;
+}
+
+
+std::ostream& operator<<(std::ostream& os, const std::set<int>& nodes)
+{
+  for (auto itr=nodes.begin(); itr!=nodes.end(); ++itr) {
+    os << (itr != nodes.begin() ? "," : "") << *itr;
+  }
+  return os;
+}
+
+
+void show(const std::string& label, const Outcome& out)
+{
+  std::cout << label << ": " << (out.perSample * 1e9) << "ns/sample, "
+            << "merge " << (out.merge * 1e6) << "us, "
+            << "threads on node " << out.threadNodes
+            << ", shards on node " << out.shardNodes << std::endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+  const unsigned hw = std::max(std::thread::hardware_concurrency(), 1u);
+  const unsigned nthreads = (argc > 1 ? std::atoi(argv[1]) : hw);
+  const unsigned long samples = (argc > 2 ? std::atol(argv[2]) : 2000000);
+
+  if (nthreads < 1 || samples < 1) {
+    std::cerr << "Usage: " << argv[0] << " [THREADS] [SAMPLES]" << std::endl;
+    return 1;
+  }
+
+  std::cout << nthreads << " threads, " << samples << " samples each"
+            << std::endl;
+
+  // Alternate the strategies, so that neither always runs on a cold cache:
+  for (unsigned rep=0; rep<2; ++rep) {
+    show("local", runLocal(nthreads, samples));
+    show("heap ", runHeap(nthreads, samples));
+  }
+  std::cout << "entry: " << (runEntry(nthreads, samples) * 1e9)
+            << "ns/sample" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,217 @@
+/*
+ *  Unit-tests for latency-driven admission control
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include "testdefns.hpp"
+
+#if RTIMERS_HAVE_CXX11
+#  include "rtimers/admission.hpp"
+#endif
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+#if RTIMERS_HAVE_CXX11
+
+namespace {
+
+typedef AdmissionController<ManualClock> Admission;
+
+//! Outcome of simulating a single-server queue over some period
+struct QueueSim
+{
+  QueueSim()
+    : served(0), offered(0), worst(0.0) {}
+
+  unsigned long served, offered;
+  double worst;
+};
+
+/*! Simulate requests arriving at a fixed rate at a single server
+ *
+ *  \param finish   Time at which the server next becomes idle,
+ *                  which is carried between calls
+ */
+QueueSim simulate(RegistryEntry& entry, Admission* admission,
+                  double arrivalRate, double serviceTime,
+                  double duration, double& finish)
+{
+  QueueSim sim;
+  const double gap = 1.0 / arrivalRate;
+
+  for (double elapsed=0.0; elapsed<duration; elapsed+=gap) {
+    ManualClock::advance(gap);
+    ++sim.offered;
+    if (admission && !admission->shouldAdmit()) continue;
+
+    const double now = ManualClock::now();
+    finish = std::max(finish, now) + serviceTime;
+    const double latency = finish - now;
+    entry.addSample(latency);
+
+    ++sim.served;
+    sim.worst = std::max(sim.worst, latency);
+  }
+
+  return sim;
+}
+
+
+//! Observer which takes a while to process each sample
+struct SlowObserver : public SampleObserver
+{
+  SlowObserver()
+    : inside(false), calls(0) {}
+
+  void observe(double) {
+    inside = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ++calls;
+    inside = false;
+  }
+
+  std::atomic<bool> inside;
+  std::atomic<unsigned> calls;
+};
+
+}   // namespace
+
+#endif  // RTIMERS_HAVE_CXX11
+
+
+TestAdmission::TestAdmission()
+  : BoostUT::test_suite("admission control")
+{
+  add(BOOST_TEST_CASE(window));
+  add(BOOST_TEST_CASE(overload));
+  add(BOOST_TEST_CASE(observers));
+}
+
+
+void TestAdmission::window()
+{
+#if RTIMERS_HAVE_CXX11
+  LatencyWindow<ManualClock> window(10e-3, 0.1);
+
+  for (unsigned i=0; i<10; ++i) {
+    window.add(i < 3 ? 20e-3 : 1e-3);
+    ManualClock::advance(0.01 + 1e-9);
+  }
+  const long ep = window.add(5e-3);
+  BOOST_CHECK_EQUAL(ep, 1);
+
+  LatencyWindow<ManualClock>::Totals tot = window.recent(ep, 4);
+  BOOST_CHECK_EQUAL(tot.count, 10);
+  BOOST_CHECK_EQUAL(tot.over, 3);
+
+  ManualClock::advance(1.0);
+  tot = window.recent(window.add(1e-3), 4);
+  BOOST_CHECK_EQUAL(tot.count, 0);
+#endif
+}
+
+
+void TestAdmission::overload()
+{
+#if RTIMERS_HAVE_CXX11
+  Registry registry;
+  RegistryEntry& entry = registry.lookup("served");
+  const double slo = 20e-3, service = 1e-3;
+  double finish = ManualClock::now();
+
+  // Without control, the queue grows throughout an overload:
+  const QueueSim open = simulate(entry, NULL, 1500.0, service, 5.0, finish);
+  BOOST_CHECK_GT(open.worst, 1.0);
+
+  finish = ManualClock::now();
+  Admission admission(entry, slo, 0.99, 0.1);
+  BOOST_CHECK(admission.shouldAdmit());
+  BOOST_CHECK_EQUAL(admission.getRejectFraction(), 0.0);
+
+  // Light load is always admitted:
+  QueueSim light = simulate(entry, &admission, 500.0, service, 5.0, finish);
+  BOOST_CHECK_EQUAL(light.served, light.offered);
+
+  // Overload is shed until throughput matches capacity:
+  simulate(entry, &admission, 1500.0, service, 20.0, finish);
+  double lowest = 1.0, highest = 0.0;
+  unsigned long served = 0, offered = 0;
+  double worst = 0.0;
+  for (unsigned i=0; i<40; ++i) {
+    const QueueSim part = simulate(entry, &admission, 1500.0, service,
+                                   0.25, finish);
+    served += part.served;
+    offered += part.offered;
+    worst = std::max(worst, part.worst);
+    lowest = std::min(lowest, admission.getRejectFraction());
+    highest = std::max(highest, admission.getRejectFraction());
+  }
+  BOOST_CHECK_CLOSE(double(served) / offered, 1.0 / 1.5, 10.0);
+  BOOST_CHECK_LT(worst, 5 * slo);
+  BOOST_CHECK_GT(lowest, 0.15);
+  BOOST_CHECK_LT(highest, 0.6);
+
+  // Shedding stops once the overload has passed:
+  simulate(entry, &admission, 500.0, service, 10.0, finish);
+  BOOST_CHECK_EQUAL(admission.getRejectFraction(), 0.0);
+  light = simulate(entry, &admission, 500.0, service, 1.0, finish);
+  BOOST_CHECK_EQUAL(light.served, light.offered);
+
+  // Disabling the timer's statistics should not freeze the controller:
+  simulate(entry, &admission, 1500.0, service, 5.0, finish);
+  BOOST_CHECK_GT(admission.getRejectFraction(), 0.0);
+  entry.setEnabled(false);
+  const unsigned long recorded = entry.read().count;
+  simulate(entry, &admission, 500.0, service, 10.0, finish);
+  BOOST_CHECK_EQUAL(admission.getRejectFraction(), 0.0);
+  BOOST_CHECK_EQUAL(entry.read().count, recorded);
+#endif
+}
+
+
+void TestAdmission::observers()
+{
+#if RTIMERS_HAVE_CXX11
+  Registry registry;
+  RegistryEntry& entry = registry.lookup("observed");
+
+  { Admission first(entry, 20e-3);
+    BOOST_CHECK_THROW(Admission(entry, 10e-3), std::logic_error);
+  }
+  { Admission replacement(entry, 20e-3);
+    BOOST_CHECK(replacement.shouldAdmit());
+  }
+
+  // Detaching should wait for an observation already in progress:
+  SlowObserver slow;
+  BOOST_REQUIRE(entry.setObserver(&slow));
+  std::thread sampler([&entry]() { entry.addSample(1e-3); });
+  while (!slow.inside) std::this_thread::yield();
+  BOOST_CHECK(entry.setObserver(NULL));
+  BOOST_CHECK(!slow.inside);
+  BOOST_CHECK_EQUAL(slow.calls.load(), 1);
+  sampler.join();
+
+  entry.addSample(1e-3);
+  BOOST_CHECK_EQUAL(slow.calls.load(), 1);
+  BOOST_CHECK_EQUAL(entry.read().count, 2);
+#endif
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers
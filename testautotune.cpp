@@ -0,0 +1,167 @@
+/*
+ *  Unit-tests for offline parameter tuning
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <boost/test/unit_test.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+#include "testdefns.hpp"
+
+#if RTIMERS_HAVE_CXX11
+#  include "rtimers/autotune.hpp"
+#endif
+#if RTIMERS_HAVE_POSIX
+#  include <unistd.h>
+#endif
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+#if RTIMERS_HAVE_CXX11
+
+namespace {
+
+typedef Autotuner<ManualClock> SimTuner;
+
+unsigned workloadCalls = 0;
+
+//! Simulated workload, fastest with tile=32, threads=4
+void workload(const TuningConfig& config)
+{
+  const double tile = config.at("tile") - 32.0;
+  const double threads = config.at("threads") - 4.0;
+
+  ++workloadCalls;
+  ManualClock::advance(1e-6 + tile * tile * 1e-9 + threads * threads * 1e-8
+                       + ((workloadCalls % 7) == 0 ? 1e-3 : 0.0));
+}
+
+ParameterSpace makeSpace()
+{
+  ParameterSpace space;
+  space.add("tile", { 8, 16, 32, 64, 128 })
+       .add("threads", { 1, 2, 4, 8 });
+  return space;
+}
+
+}   // namespace (anonymous)
+
+#endif  // RTIMERS_HAVE_CXX11
+
+
+TestAutotune::TestAutotune()
+  : BoostUT::test_suite("parameter autotuning")
+{
+  add(BOOST_TEST_CASE(space));
+  add(BOOST_TEST_CASE(strategies));
+  add(BOOST_TEST_CASE(persistence));
+}
+
+
+void TestAutotune::space()
+{
+#if RTIMERS_HAVE_CXX11
+  const ParameterSpace space = makeSpace();
+
+  BOOST_CHECK_EQUAL(space.size(), 20);
+  BOOST_CHECK_EQUAL(space.at(0).at("tile"), 8);
+  BOOST_CHECK_EQUAL(space.at(0).at("threads"), 1);
+  BOOST_CHECK_EQUAL(space.at(7).at("tile"), 32);
+  BOOST_CHECK_EQUAL(space.at(7).at("threads"), 2);
+  BOOST_CHECK_EQUAL(space.at(19).at("tile"), 128);
+  BOOST_CHECK_EQUAL(space.at(19).at("threads"), 8);
+  BOOST_CHECK_EQUAL(ParameterSpace().size(), 0);
+#endif
+}
+
+
+void TestAutotune::strategies()
+{
+#if RTIMERS_HAVE_CXX11
+  const ParameterSpace space = makeSpace();
+
+  // Exhaustive search, which is robust against one-in-seven slow calls:
+  workloadCalls = 0;
+  SimTuner grid(space, SimTuner::GRID, 5);
+  const TuningConfig gridBest = grid.tune(workload);
+  BOOST_CHECK_EQUAL(gridBest.at("tile"), 32);
+  BOOST_CHECK_EQUAL(gridBest.at("threads"), 4);
+  BOOST_CHECK_EQUAL(grid.getTrials().size(), 20);
+  BOOST_CHECK_EQUAL(workloadCalls, 20 * 6);
+
+  // Random subset, whose best should be the fastest point visited:
+  SimTuner random(space, SimTuner::RANDOM, 5, 8);
+  const TuningConfig randomBest = random.tune(workload);
+  BOOST_REQUIRE_EQUAL(random.getTrials().size(), 8);
+  double bestMedian = 1e18;
+  for (auto& trial : random.getTrials()) {
+    BOOST_CHECK_EQUAL(trial.times.size(), 5);
+    if (trial.config == randomBest) bestMedian = trial.median();
+  }
+  for (auto& trial : random.getTrials()) {
+    BOOST_CHECK_LE(bestMedian, trial.median());
+  }
+
+  // Successive halving, spending most time on the most promising points:
+  SimTuner halving(space, SimTuner::HALVING, 3, 20);
+  const TuningConfig halvingBest = halving.tune(workload);
+  BOOST_CHECK_EQUAL(halvingBest.at("tile"), 32);
+  BOOST_CHECK_EQUAL(halvingBest.at("threads"), 4);
+
+  unsigned briefest = 0;
+  for (auto& trial : halving.getTrials()) {
+    if (trial.times.size() == 3) ++briefest;
+    if (trial.config == halvingBest) {
+      BOOST_CHECK_EQUAL(trial.times.size(), 3 + 6 + 12 + 24 + 48);
+    }
+  }
+  BOOST_CHECK_EQUAL(briefest, 10);
+
+  std::ostringstream report;
+  report << halving.getTrials()[0];
+  BOOST_CHECK(report.str().find("threads=") == 0);
+#endif
+}
+
+
+void TestAutotune::persistence()
+{
+#if RTIMERS_HAVE_CXX11 && RTIMERS_HAVE_POSIX
+  char path[] = "/tmp/rtimers-tune-XXXXXX";
+  const int fd = mkstemp(path);
+  BOOST_REQUIRE(fd >= 0);
+  close(fd);
+
+  TuningConfig best;
+  best["tile"] = 64;
+  best["threads"] = -3;
+  BOOST_CHECK(saveTuning(path, best));
+
+  TuningConfig defaults;
+  defaults["tile"] = 16;
+  defaults["unroll"] = 4;
+  const TuningConfig loaded = loadTuning(path, defaults);
+  BOOST_CHECK_EQUAL(loaded.size(), 3);
+  BOOST_CHECK_EQUAL(loaded.at("tile"), 64);
+  BOOST_CHECK_EQUAL(loaded.at("threads"), -3);
+  BOOST_CHECK_EQUAL(loaded.at("unroll"), 4);
+
+  std::remove(path);
+  BOOST_CHECK(loadTuning(path, defaults) == defaults);
+#endif
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers
@@ -0,0 +1,136 @@
+/*
+ *  Unit-tests for clock calibration and cross-core consistency
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+
+#include "testdefns.hpp"
+
+#if RTIMERS_HAVE_POSIX
+#  include <sched.h>
+#  include <thread>
+#  include "rtimers/clockcheck.hpp"
+#  include "rtimers/cxx11.hpp"
+#endif
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+
+TestClockCheck::TestClockCheck()
+  : BoostUT::test_suite("clock calibration")
+{
+  add(BOOST_TEST_CASE(anchoring));
+  add(BOOST_TEST_CASE(interpolation));
+  add(BOOST_TEST_CASE(crossCore));
+}
+
+
+void TestClockCheck::anchoring()
+{
+#if RTIMERS_HAVE_POSIX
+  typedef cxx11::HiResClock CLK;
+  ClockCalibrator<CLK> calib;
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  BOOST_CHECK_LT(calib.anchor(), 1e-3);
+  const std::vector<ClockAnchor> table = calib.getAnchors();
+  BOOST_REQUIRE_EQUAL(table.size(), 2);
+
+  const ClockAnchor& a = table[0];
+  const ClockAnchor& b = table[1];
+  BOOST_CHECK_GT(b.fast - a.fast, 19e-3);
+  BOOST_CHECK_CLOSE(b.monotonic - a.monotonic, b.fast - a.fast, 5.0);
+  BOOST_CHECK_GT(a.realtime, 1.5e9);
+  BOOST_CHECK_LT(std::fabs(calib.driftPPM()), 5e4);
+
+  timespec wall;
+  const CLK::Instant now = CLK::now();
+  clock_gettime(CLOCK_REALTIME, &wall);
+  BOOST_CHECK_LT(std::fabs(calib.toRealtime(now)
+                            - (wall.tv_sec + 1e-9 * wall.tv_nsec)), 2e-3);
+
+  std::ostringstream csv;
+  calib.writeTable(csv);
+  BOOST_CHECK(csv.str().find("fast,monotonic,realtime,window\n") == 0);
+#endif
+}
+
+
+void TestClockCheck::interpolation()
+{
+#if RTIMERS_HAVE_POSIX
+  // Simulate a fast clock running 1% fast, and a step in wall-clock time:
+  struct Calib : ClockCalibrator<ManualClock> {
+    Calib() {
+      anchors.clear();
+      anchors.push_back(ClockAnchor{ 0.0, 100.0, 1000.0, 0.0 });
+      anchors.push_back(ClockAnchor{ 10.1, 110.0, 1010.0, 0.0 });
+      anchors.push_back(ClockAnchor{ 20.2, 120.0, 1030.0, 0.0 });
+    }
+  } calib;
+  const double eps = 1e-9;
+  const double t0 = ManualClock::now();
+
+  BOOST_CHECK_CLOSE(calib.driftPPM(), 1e4, eps);
+  BOOST_CHECK_CLOSE(calib.toMonotonic(t0 + 5.05), 105.0, eps);
+  BOOST_CHECK_CLOSE(calib.toRealtime(t0 + 5.05), 1005.0, eps);
+  BOOST_CHECK_CLOSE(calib.toRealtime(t0 + 15.15), 1020.0, eps);
+  BOOST_CHECK_CLOSE(calib.toRealtime(t0 + 30.3), 1050.0, eps);
+  BOOST_CHECK_CLOSE(calib.toMonotonic(t0 - 10.1), 90.0, eps);
+
+  // The table should be thinned, keeping its end-points, once full:
+  ClockCalibrator<ManualClock> bounded(2, 8);
+  for (unsigned i=0; i<40; ++i) {
+    ManualClock::advance(1.0);
+    bounded.anchor();
+  }
+  const std::vector<ClockAnchor> table = bounded.getAnchors();
+  BOOST_CHECK_LE(table.size(), 8);
+  BOOST_CHECK_GE(table.size(), 4);
+  BOOST_CHECK_EQUAL(table.front().fast, 0.0);
+  BOOST_CHECK_CLOSE(table.back().fast, 40.0, eps);
+  for (size_t i=1; i<table.size(); ++i) {
+    BOOST_CHECK_GT(table[i].fast, table[i - 1].fast);
+  }
+  BOOST_CHECK_CLOSE(bounded.toMonotonic(ManualClock::now()),
+                    table.back().monotonic, eps);
+#endif
+}
+
+
+void TestClockCheck::crossCore()
+{
+#if RTIMERS_HAVE_POSIX
+  typedef ClockCalibrator<cxx11::HiResClock> Calib;
+  cpu_set_t mask;
+  BOOST_REQUIRE_EQUAL(sched_getaffinity(0, sizeof(mask), &mask), 0);
+  const int nCPUs = CPU_COUNT(&mask);
+
+  const std::vector<CoreSkew> skews = Calib::measureSkew(-1, 200);
+  BOOST_REQUIRE_EQUAL(skews.size(), nCPUs - 1);
+
+  for (size_t i=0; i<skews.size(); ++i) {
+    BOOST_CHECK_LT(skews[i].roundTrip, 1e-3);
+    BOOST_CHECK_LE(std::fabs(skews[i].offset), 0.5 * skews[i].roundTrip + 1e-6);
+
+    std::ostringstream report;
+    report << skews[i];
+    BOOST_CHECK(report.str().find("cpu") == 0);
+  }
+#endif
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers
@@ -0,0 +1,159 @@
+/*
+ *  Unit-tests for live reconfiguration of registered timers
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+
+#include "testdefns.hpp"
+
+#if RTIMERS_HAVE_POSIX
+#  include "rtimers/control.hpp"
+#endif
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+#if RTIMERS_HAVE_POSIX
+
+namespace {
+
+typedef TimerControl<CollectingLogger> Control;
+
+//! Replace a file atomically, as an editor or deployment script might
+void replaceFile(const std::string& path, const std::string& content)
+{
+  const std::string tmp = path + ".new";
+  { std::ofstream strm(tmp.c_str());
+    strm << content;
+  }
+  std::rename(tmp.c_str(), path.c_str());
+}
+
+bool awaitReloads(const Control& control, unsigned long target)
+{
+  for (unsigned i=0; i<500; ++i) {
+    if (control.getReloads() >= target) return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  return false;
+}
+
+}   // namespace
+
+#endif  // RTIMERS_HAVE_POSIX
+
+
+TestControl::TestControl()
+  : BoostUT::test_suite("live timer reconfiguration")
+{
+  add(BOOST_TEST_CASE(rules));
+  add(BOOST_TEST_CASE(watching));
+}
+
+
+void TestControl::rules()
+{
+#if RTIMERS_HAVE_POSIX
+  Registry registry;
+  RegistryEntry& read = registry.lookup("db.read");
+  RegistryEntry& write = registry.lookup("db.write");
+  RegistryEntry& get = registry.lookup("http.get");
+  Control control(registry, "/nonexistent/timers.ctl");
+  BOOST_CHECK_EQUAL(control.getReloads(), 0);
+
+  BOOST_REQUIRE(control.apply("# incident 42\n"
+                              "sample * 4\n"
+                              "disable db.\n"
+                              "enable db.read\n"
+                              "trace http.\n"));
+  BOOST_CHECK(read.isEnabled());
+  BOOST_CHECK(!write.isEnabled());
+  BOOST_CHECK_EQUAL(get.getFlags(),
+                    RegistryEntry::makeFlags(true, true, 2));
+
+  for (unsigned i=0; i<100; ++i) {
+    read.addSample(1e-3);
+    write.addSample(1e-3);
+  }
+  const HistogramStats sampled = read.read();
+  BOOST_CHECK_EQUAL(sampled.count, 100);
+  BOOST_CHECK_CLOSE(sampled.total, 0.1, 1e-6);
+  BOOST_CHECK_EQUAL(write.read().count, 0);
+
+  // Timers created after the rules were applied should follow them:
+  BOOST_CHECK(!registry.lookup("db.delete").isEnabled());
+  BOOST_CHECK_EQUAL(registry.lookup("http.put").getFlags(),
+                    RegistryEntry::makeFlags(true, true, 2));
+
+  BOOST_CHECK(!control.apply("sample db. 0\n"));
+  BOOST_CHECK(!control.apply("enable\n"));
+  BOOST_CHECK(!control.apply("enable db.\nfrobnicate db.\n"));
+  BOOST_CHECK(!write.isEnabled());
+  BOOST_CHECK_EQUAL(control.getReloads(), 1);
+
+  CollectingLogger::rows.clear();
+  BOOST_REQUIRE(control.apply("sample db.read 3\ndump\n"));
+  BOOST_CHECK_EQUAL(CollectingLogger::rows.size(), 5);
+  BOOST_CHECK(write.isEnabled());
+  BOOST_CHECK_EQUAL(read.getFlags(), RegistryEntry::makeFlags(true, false, 2));
+  BOOST_CHECK_EQUAL(get.getFlags(), RegistryEntry::makeFlags(true));
+#endif
+}
+
+
+void TestControl::watching()
+{
+#if RTIMERS_HAVE_POSIX
+  TempDir tmp("control");
+  BOOST_REQUIRE(!tmp.path.empty());
+  const std::string ctl = tmp.path + "/timers.ctl";
+
+  Registry registry;
+  RegistryEntry& entry = registry.lookup("worker.step");
+  replaceFile(ctl, "disable worker.\n");
+
+  Control control(registry, ctl);
+  BOOST_CHECK_EQUAL(control.getReloads(), 1);
+  BOOST_CHECK(!entry.isEnabled());
+
+  if (control.isWatching()) {
+    replaceFile(tmp.path + "/unrelated", "enable *\n");
+    replaceFile(ctl, "trace worker.step\n");
+    BOOST_REQUIRE(awaitReloads(control, 2));
+    BOOST_CHECK(entry.isEnabled());
+    BOOST_CHECK(entry.getFlags() & RegistryEntry::TRACED);
+  }
+
+  BOOST_REQUIRE(control.handleSignal(SIGUSR2));
+  const unsigned long settled = control.getReloads();
+  raise(SIGUSR2);
+  BOOST_REQUIRE(awaitReloads(control, settled + 1));
+
+  { std::ofstream strm(ctl.c_str());
+    strm << "sample * 8\n";
+  }
+  raise(SIGUSR2);
+  for (unsigned i=0; i<500 && !(entry.getFlags() >> RegistryEntry::SAMPLE_SHIFT);
+       ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  BOOST_CHECK_EQUAL(entry.getFlags(), RegistryEntry::makeFlags(true, false, 3));
+#endif
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers
@@ -11,6 +11,10 @@
 #pragma once
 
 #include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
 #include "rtimers/core.hpp"
 
 #if __cplusplus >= 201100
@@ -46,6 +50,88 @@ double occupyTimer(TMR& timer, unsigned iterations) {
 }
 
 
+/** Artificial clock, advanced explicitly by test code */
+struct ManualClock
+{
+  typedef double Instant;
+
+  static Instant now() {
+    return current;
+  }
+
+  static double interval(const Instant& start, const Instant& end) {
+    return (end - start);
+  }
+
+  static void advance(double dt) {
+    current += dt;
+  }
+
+  static Instant current;
+};
+
+
+/** Timer-statistics reporter which collects each report as "ident: stats" */
+struct CollectingLogger
+{
+  template <typename STATS>
+  static void report(const std::string& ident, const STATS& stats) {
+    std::ostringstream strm;
+    strm << ident << ": " << stats;
+    rows.push_back(strm.str());
+  }
+
+  //! The identifier from one of the collected rows
+  static std::string ident(size_t idx) {
+    return rows.at(idx).substr(0, rows.at(idx).find(": "));
+  }
+
+  static std::vector<std::string> rows;
+};
+
+
+#if RTIMERS_HAVE_POSIX
+
+//! Temporary directory, removed with its contents when out of scope
+struct TempDir
+{
+  explicit TempDir(const std::string& label) {
+    std::string templ = "/tmp/rtimers-" + label + "-XXXXXX";
+    path = (mkdtemp(&templ[0]) ? templ : "");
+  }
+  ~TempDir() {
+    if (!path.empty()) {
+      const std::string cmd = "rm -rf '" + path + "'";
+      if (std::system(cmd.c_str()) != 0) {}
+    }
+  }
+
+  std::string path;
+};
+
+#endif  // RTIMERS_HAVE_POSIX
+
+
+struct TestAdmission : boost::unit_test::test_suite
+{
+  TestAdmission();
+
+  static void window();
+  static void overload();
+  static void observers();
+};
+
+
+struct TestAutotune : boost::unit_test::test_suite
+{
+  TestAutotune();
+
+  static void space();
+  static void strategies();
+  static void persistence();
+};
+
+
 struct TestBoost : boost::unit_test::test_suite
 {
   TestBoost();
@@ -54,6 +140,25 @@ struct TestBoost : boost::unit_test::test_suite
 };
 
 
+struct TestClockCheck : boost::unit_test::test_suite
+{
+  TestClockCheck();
+
+  static void anchoring();
+  static void interpolation();
+  static void crossCore();
+};
+
+
+struct TestControl : boost::unit_test::test_suite
+{
+  TestControl();
+
+  static void rules();
+  static void watching();
+};
+
+
 struct TestCxx11 : boost::unit_test::test_suite
 {
   TestCxx11();
@@ -63,6 +168,125 @@ struct TestCxx11 : boost::unit_test::test_suite
 };
 
 
+struct TestEndpoint : boost::unit_test::test_suite
+{
+  TestEndpoint();
+
+  static void requests();
+  static void socket();
+  static void stalling();
+};
+
+
+struct TestFtrace : boost::unit_test::test_suite
+{
+  TestFtrace();
+
+  static void records();
+  static void switching();
+};
+
+
+struct TestInstrument : boost::unit_test::test_suite
+{
+  TestInstrument();
+
+  static void nesting();
+};
+
+
+struct TestLoadGen : boost::unit_test::test_suite
+{
+  TestLoadGen();
+
+  static void schedules();
+  static void queueing();
+  static void sweep();
+};
+
+
+struct TestLoop : boost::unit_test::test_suite
+{
+  TestLoop();
+
+  static void steady();
+  static void lateness();
+};
+
+
+struct TestRegistry : boost::unit_test::test_suite
+{
+  TestRegistry();
+
+  static void histogram();
+  static void entries();
+  static void shards();
+  static void threads();
+  static void transient();
+  static void snapshots();
+};
+
+
+struct TestRotating : boost::unit_test::test_suite
+{
+  TestRotating();
+
+  static void rotation();
+  static void freezing();
+  static void periodic();
+  static void restarting();
+};
+
+
+struct TestSampling : boost::unit_test::test_suite
+{
+  TestSampling();
+
+  static void scopes();
+  static void stacking();
+};
+
+
+struct TestSelector : boost::unit_test::test_suite
+{
+  TestSelector();
+
+  static void classes();
+  static void greedy();
+  static void confidence();
+  static void adding();
+};
+
+
+struct TestStall : boost::unit_test::test_suite
+{
+  TestStall();
+
+  static void heartbeat();
+  static void flagging();
+  static void tracing();
+};
+
+
+struct TestParallel : boost::unit_test::test_suite
+{
+  TestParallel();
+
+  static void simulated();
+  static void threaded();
+};
+
+
+struct TestPatch : boost::unit_test::test_suite
+{
+  TestPatch();
+
+  static void signals();
+  static void toggling();
+  static void concurrent();
+};
+
+
 struct TestPosix : boost::unit_test::test_suite
 {
   TestPosix();
@@ -72,5 +296,33 @@ struct TestPosix : boost::unit_test::test_suite
 };
 
 
+struct TestStartup : boost::unit_test::test_suite
+{
+  TestStartup();
+
+  static void milestones();
+};
+
+
+struct TestUring : boost::unit_test::test_suite
+{
+  TestUring();
+
+  static void fileIO();
+  static void queueFull();
+  static void externalRing();
+};
+
+
+struct TestUsdt : boost::unit_test::test_suite
+{
+  TestUsdt();
+
+  static void notes();
+  static void semaphores();
+  static void legacy();
+};
+
+
   }   // namespace testing
 }   // namespace rtimers
@@ -0,0 +1,180 @@
+/*
+ *  Unit-tests for the Unix-domain-socket query endpoint
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+#include "testdefns.hpp"
+
+#if RTIMERS_HAVE_POSIX
+#  include "rtimers/endpoint.hpp"
+#endif
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+#if RTIMERS_HAVE_POSIX
+
+namespace {
+
+void populate(Registry& registry)
+{
+  registry.lookup("db.read").addSample(2e-3);
+  registry.lookup("db.read").addSample(4e-3);
+  registry.lookup("db.write").addSample(5e-3);
+  registry.lookup("http.get").addSample(1e-3);
+}
+
+}   // namespace
+
+#endif  // RTIMERS_HAVE_POSIX
+
+
+TestEndpoint::TestEndpoint()
+  : BoostUT::test_suite("socket query endpoint")
+{
+  add(BOOST_TEST_CASE(requests));
+  add(BOOST_TEST_CASE(socket));
+  add(BOOST_TEST_CASE(stalling));
+}
+
+
+void TestEndpoint::requests()
+{
+#if RTIMERS_HAVE_POSIX
+  Registry registry;
+  populate(registry);
+  StatsEndpoint endpoint(registry, "");
+  BOOST_CHECK(!endpoint.isListening());
+
+  BOOST_CHECK_EQUAL(endpoint.answer("list"),
+                    "db.read\ton\ndb.write\ton\nhttp.get\ton\n");
+
+  const std::string stats = endpoint.answer("stats db.");
+  BOOST_CHECK_EQUAL(stats.find("Timer(db.read): <t> = 3ms"), 0u);
+  BOOST_CHECK_NE(stats.find("Timer(db.write): "), std::string::npos);
+  BOOST_CHECK_EQUAL(stats.find("http"), std::string::npos);
+
+  BOOST_CHECK_EQUAL(endpoint.answer("disable db."), "disabled 2\n");
+  registry.lookup("db.read").addSample(1.0);
+  registry.lookup("http.get").addSample(1e-3);
+  BOOST_CHECK_EQUAL(registry.lookup("db.read").read().count, 2);
+  BOOST_CHECK_EQUAL(registry.lookup("http.get").read().count, 2);
+  BOOST_CHECK_EQUAL(endpoint.answer("list db.w"), "db.write\toff\n");
+
+  BOOST_CHECK_EQUAL(endpoint.answer("enable"), "enabled 3\n");
+  BOOST_CHECK_EQUAL(endpoint.answer("reset http"), "reset 1\n");
+  BOOST_CHECK_EQUAL(registry.lookup("http.get").read().count, 0);
+  BOOST_CHECK_EQUAL(registry.lookup("db.read").read().count, 2);
+
+  BOOST_CHECK_EQUAL(endpoint.answer("frobnicate"),
+                    "error: unknown request 'frobnicate'\n");
+#endif
+}
+
+
+void TestEndpoint::socket()
+{
+#if RTIMERS_HAVE_POSIX
+  TempDir tmp("endpoint");
+  BOOST_REQUIRE(!tmp.path.empty());
+  const std::string sock = tmp.path + "/timers.sock";
+  std::string response;
+
+  Registry registry;
+  populate(registry);
+
+  {
+    StatsEndpoint endpoint(registry, sock);
+    BOOST_REQUIRE(endpoint.isListening());
+
+    BOOST_REQUIRE(StatsEndpoint::query(sock, "list http", response));
+    BOOST_CHECK_EQUAL(response, "http.get\ton\n");
+
+    BOOST_REQUIRE(StatsEndpoint::query(sock, "stats db.write", response));
+    BOOST_CHECK_EQUAL(response.find("Timer(db.write): <t> = 5ms"), 0u);
+
+    for (unsigned i=0; i<20; ++i) {
+      BOOST_REQUIRE(StatsEndpoint::query(sock, "reset db.", response));
+      BOOST_CHECK_EQUAL(response, "reset 2\n");
+    }
+    BOOST_CHECK_EQUAL(registry.lookup("db.read").read().count, 0);
+  }
+
+  BOOST_CHECK(!StatsEndpoint::query(sock, "list", response));
+#endif
+}
+
+
+void TestEndpoint::stalling()
+{
+#if RTIMERS_HAVE_POSIX
+  TempDir tmp("endpoint");
+  BOOST_REQUIRE(!tmp.path.empty());
+  const std::string sock = tmp.path + "/timers.sock";
+  std::string response;
+
+  // Files other than sockets should never be replaced:
+  const std::string plain = tmp.path + "/plain";
+  std::ofstream(plain.c_str()) << "precious\n";
+  Registry registry;
+  {
+    StatsEndpoint endpoint(registry, plain);
+    BOOST_CHECK(!endpoint.isListening());
+  }
+  struct stat info;
+  BOOST_REQUIRE_EQUAL(::stat(plain.c_str(), &info), 0);
+  BOOST_CHECK(S_ISREG(info.st_mode));
+
+  // Make a response much larger than the socket's buffer:
+  for (unsigned i=0; i<20000; ++i) {
+    std::ostringstream name;
+    name << "stalling.timer-with-a-rather-long-name." << i;
+    registry.lookup(name.str());
+  }
+
+  typedef std::chrono::steady_clock Clock;
+  const Clock::time_point start = Clock::now();
+  {
+    StatsEndpoint endpoint(registry, sock);
+    BOOST_REQUIRE(endpoint.isListening());
+    BOOST_REQUIRE_EQUAL(::stat(sock.c_str(), &info), 0);
+    BOOST_CHECK_EQUAL(info.st_mode & 0777, 0600);
+
+    // A client which never reads its response:
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, sock.c_str());
+    const int idle = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    BOOST_REQUIRE_EQUAL(::connect(idle, reinterpret_cast<sockaddr*>(&addr),
+                                  sizeof(addr)), 0);
+    BOOST_REQUIRE_EQUAL(::write(idle, "list\n", 5), 5);
+
+    BOOST_CHECK(StatsEndpoint::query(sock, "list http", response));
+    BOOST_CHECK_EQUAL(response, "");
+    ::close(idle);
+  }
+  BOOST_CHECK_LT(std::chrono::duration<double>(Clock::now() - start).count(),
+                 5.0);
+#endif
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers
@@ -0,0 +1,155 @@
+/*
+ *  Unit-tests for ftrace trace_marker records
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "testdefns.hpp"
+
+#if RTIMERS_HAVE_POSIX
+#  include <cstdlib>
+#  include <cstring>
+#  include <unistd.h>
+#  include "rtimers/ftrace.hpp"
+#endif
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+#if RTIMERS_HAVE_POSIX
+
+typedef Timer<ftrace::TraceMarkerManager<SerialManager<C89clock, BoundStats> >,
+              NullLogger> TracedTimer;
+
+//! Create an empty temporary file, returning its name
+static std::string makeTempFile(const char* contents="")
+{
+  char path[] = "/tmp/rtimers-ftrace-XXXXXX";
+  const int fd = mkstemp(path);
+  if (fd >= 0) {
+    if (write(fd, contents, strlen(contents)) < 0) {}
+    close(fd);
+  }
+  return path;
+}
+
+static std::string slurp(const std::string& path)
+{
+  std::ifstream strm(path.c_str());
+  std::stringstream contents;
+  contents << strm.rdbuf();
+  return contents.str();
+}
+
+static unsigned countOccurrences(const std::string& text,
+                                 const std::string& pattern)
+{
+  unsigned count = 0;
+  for (size_t pos = text.find(pattern); pos != std::string::npos;
+       pos = text.find(pattern, pos + 1)) {
+    ++count;
+  }
+  return count;
+}
+
+#endif  // RTIMERS_HAVE_POSIX
+
+
+TestFtrace::TestFtrace()
+  : BoostUT::test_suite("ftrace trace_marker records")
+{
+  add(BOOST_TEST_CASE(records));
+  add(BOOST_TEST_CASE(switching));
+}
+
+
+void TestFtrace::records()
+{
+#if RTIMERS_HAVE_POSIX
+  ftrace::TraceMarker& marker = ftrace::TraceMarker::global();
+  const std::string markerPath = makeTempFile();
+  std::ostringstream pid;
+  pid << getpid();
+
+  BOOST_REQUIRE(marker.open(markerPath, ""));
+  BOOST_CHECK(marker.isEnabled());
+
+  { TracedTimer tmr("traced");
+    for (unsigned i=0; i<3; ++i) {
+      TracedTimer::Scoper sc = tmr.scopedStart();
+    }
+    BOOST_CHECK_EQUAL(tmr.getStats().count, 3);
+  }
+  marker.close();
+
+  const std::string trace = slurp(markerPath);
+  BOOST_CHECK_EQUAL(countOccurrences(trace, "B|" + pid.str() + "|traced"), 3);
+  BOOST_CHECK_EQUAL(countOccurrences(trace, "E|" + pid.str()), 3);
+
+  unlink(markerPath.c_str());
+#else
+  BOOST_ERROR("No POSIX file support");
+#endif  // RTIMERS_HAVE_POSIX
+}
+
+
+void TestFtrace::switching()
+{
+#if RTIMERS_HAVE_POSIX
+  ftrace::TraceMarker& marker = ftrace::TraceMarker::global();
+  const std::string markerPath = makeTempFile();
+  const std::string enablePath = makeTempFile("0\n");
+
+  BOOST_REQUIRE(marker.open(markerPath, enablePath));
+  BOOST_CHECK(!marker.isEnabled());
+
+  TracedTimer tmr("switched");
+  tmr.start();
+  tmr.stop();
+
+  { std::ofstream flag(enablePath.c_str());
+    flag << "1\n";
+  }
+  marker.refresh();
+  BOOST_CHECK(marker.isEnabled());
+
+  tmr.start();
+  tmr.stop();
+
+  // The switch should also be re-read periodically without refresh():
+  { std::ofstream flag(enablePath.c_str());
+    flag << "0\n";
+  }
+  bool stillOn = true;
+  for (unsigned i=0; i<10000 && stillOn; ++i) stillOn = marker.isEnabled();
+  BOOST_CHECK(!stillOn);
+
+  marker.close();
+  BOOST_CHECK(!marker.isEnabled());
+
+  const std::string trace = slurp(markerPath);
+  BOOST_CHECK_EQUAL(countOccurrences(trace, "|switched"), 1);
+  BOOST_CHECK_EQUAL(tmr.getStats().count, 2);
+
+  unlink(markerPath.c_str());
+  unlink(enablePath.c_str());
+#else
+  BOOST_ERROR("No POSIX file support");
+#endif  // RTIMERS_HAVE_POSIX
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers
@@ -0,0 +1,100 @@
+/*
+ *  Unit-tests for automatic function timing
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+
+#include "testdefns.hpp"
+#include "rtimers/instrument.hpp"
+
+extern "C" {
+void __cyg_profile_func_enter(void* fn, void* callsite);
+void __cyg_profile_func_exit(void* fn, void* callsite);
+}
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+
+//! Emulate instrumented entry to a function, with some work inside it
+static double simulateCall(void* fn, unsigned work, void* callee=NULL)
+{
+  double tot = 0.0;
+
+  __cyg_profile_func_enter(fn, NULL);
+  for (unsigned i=0; i<work; ++i) {
+    tot += std::sin(i * 0.37);
+  }
+  if (callee) {
+    tot += simulateCall(callee, 4 * work);
+  }
+  __cyg_profile_func_exit(fn, NULL);
+
+  return tot;
+}
+
+static const instrument::FunctionStats* findFunction(
+          const std::vector<instrument::FunctionStats>& functions, void* fn)
+{
+  for (size_t i=0; i<functions.size(); ++i) {
+    if (functions[i].address == fn) return &functions[i];
+  }
+  return NULL;
+}
+
+
+TestInstrument::TestInstrument()
+  : BoostUT::test_suite("automatic function instrumentation")
+{
+  add(BOOST_TEST_CASE(nesting));
+}
+
+
+void TestInstrument::nesting()
+{
+  void* outer = reinterpret_cast<void*>(&TestInstrument::nesting);
+  void* inner = reinterpret_cast<void*>(&simulateCall);
+  const unsigned calls = 50;
+
+  instrument::reset();
+  for (unsigned i=0; i<calls; ++i) {
+    simulateCall(outer, 1000, inner);
+  }
+  simulateCall(inner, 10);
+
+  const std::vector<instrument::FunctionStats> functions = instrument::collect();
+  BOOST_REQUIRE_EQUAL(functions.size(), 2);
+
+  const instrument::FunctionStats* outerStats = findFunction(functions, outer);
+  const instrument::FunctionStats* innerStats = findFunction(functions, inner);
+  BOOST_REQUIRE(outerStats != NULL && innerStats != NULL);
+
+  BOOST_CHECK_EQUAL(outerStats->count, calls);
+  BOOST_CHECK_EQUAL(innerStats->count, calls + 1);
+  BOOST_CHECK(!outerStats->name.empty());
+
+  BOOST_CHECK_GT(outerStats->inclusive, innerStats->inclusive);
+  BOOST_CHECK_LT(outerStats->exclusive, outerStats->inclusive);
+  BOOST_CHECK_LE(outerStats->exclusive + innerStats->inclusive,
+                 outerStats->inclusive * 1.001 + 1e-6);
+  BOOST_CHECK_EQUAL(innerStats->exclusive, innerStats->inclusive);
+  BOOST_CHECK_GE(functions[0].exclusive, functions[1].exclusive);
+  BOOST_CHECK_EQUAL(instrument::droppedCalls(), 0);
+
+  instrument::reset();
+  BOOST_CHECK(instrument::collect().empty());
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers
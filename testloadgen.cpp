@@ -0,0 +1,124 @@
+/*
+ *  Unit-tests for open-loop load generation
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <sstream>
+
+#include "testdefns.hpp"
+
+#if RTIMERS_HAVE_CXX11
+#  include <atomic>
+#  include <chrono>
+#  include <thread>
+#  include "rtimers/loadgen.hpp"
+#endif
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+
+TestLoadGen::TestLoadGen()
+  : BoostUT::test_suite("open-loop load generation")
+{
+  add(BOOST_TEST_CASE(schedules));
+  add(BOOST_TEST_CASE(queueing));
+  add(BOOST_TEST_CASE(sweep));
+}
+
+
+void TestLoadGen::schedules()
+{
+#if RTIMERS_HAVE_CXX11
+  LoadGenerator constant(1, LoadGenerator::CONSTANT);
+  const std::vector<double> fixed = constant.schedule(1000, 0.5);
+  BOOST_REQUIRE_EQUAL(fixed.size(), 500);
+  BOOST_CHECK_EQUAL(fixed[0], 0.0);
+  BOOST_CHECK_CLOSE(fixed[250], 0.25, 1e-9);
+
+  LoadGenerator poisson(1, LoadGenerator::POISSON);
+  const std::vector<double> random = poisson.schedule(1000, 10.0);
+  BOOST_CHECK_GT(random.size(), 9700);
+  BOOST_CHECK_LT(random.size(), 10300);
+  BOOST_CHECK(std::is_sorted(random.begin(), random.end()));
+  BOOST_CHECK_LT(random.back(), 10.0);
+
+  // Invalid rates or durations give empty results, rather than never ending:
+  BOOST_CHECK(constant.schedule(-10.0, 1.0).empty());
+  BOOST_CHECK(constant.schedule(HUGE_VAL, 1.0).empty());
+  BOOST_CHECK(poisson.schedule(0.0, 1.0).empty());
+  BOOST_CHECK(poisson.schedule(1000.0, -1.0).empty());
+  BOOST_CHECK_EQUAL(constant.run([]() {}, -1.0, 1.0).issued, 0);
+  BOOST_CHECK(constant.sweep([]() {}, 0.0, 1000.0, 4, 0.1).empty());
+#endif
+}
+
+
+void TestLoadGen::queueing()
+{
+#if RTIMERS_HAVE_CXX11
+  const auto slowCall = []() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2)); };
+
+  // Requests arrive twice as fast as a single worker can serve them:
+  LoadGenerator single(1);
+  const LoadPoint overload = single.run(slowCall, 1000, 0.05);
+  BOOST_CHECK_EQUAL(overload.issued, 50);
+  BOOST_CHECK_GE(overload.service.mean, 2e-3);
+  BOOST_CHECK_GT(overload.latency.tmax, 40e-3);
+  BOOST_CHECK_GT(overload.p99, 10 * overload.service.mean);
+  BOOST_CHECK_LT(overload.throughput, 600);
+
+  // Four workers should keep up with the same arrivals:
+  LoadGenerator pool(4);
+  std::atomic<unsigned> calls(0);
+  const LoadPoint relaxed = pool.run([&]() { slowCall(); ++calls; },
+                                     1000, 0.05);
+  BOOST_CHECK_EQUAL(relaxed.issued, 50);
+  BOOST_CHECK_EQUAL(calls.load(), 50);
+  BOOST_CHECK_LT(relaxed.p50, overload.p50);
+  BOOST_CHECK_LE(relaxed.p50, relaxed.p90);
+  BOOST_CHECK_LE(relaxed.p90, relaxed.p99);
+  BOOST_CHECK_LE(relaxed.p99, relaxed.latency.tmax);
+#endif
+}
+
+
+void TestLoadGen::sweep()
+{
+#if RTIMERS_HAVE_CXX11
+  LoadGenerator gen(2, LoadGenerator::POISSON);
+  const std::vector<LoadPoint> curve =
+    gen.sweep([]() {}, 100, 1600, 3, 0.05);
+
+  BOOST_REQUIRE_EQUAL(curve.size(), 3);
+  BOOST_CHECK_CLOSE(curve[0].rate, 100, 1e-9);
+  BOOST_CHECK_CLOSE(curve[1].rate, 400, 1e-9);
+  BOOST_CHECK_CLOSE(curve[2].rate, 1600, 1e-9);
+  BOOST_CHECK_GT(curve[2].issued, curve[0].issued);
+
+  std::ostringstream csv;
+  writeLoadCurve(csv, curve);
+  const std::string text = csv.str();
+  BOOST_CHECK(text.find("rate,throughput,mean,p50") == 0);
+  BOOST_CHECK_EQUAL(std::count(text.begin(), text.end(), '\n'), 4);
+
+  std::ostringstream report;
+  report << curve[1];
+  BOOST_CHECK(report.str().find("rate = 400/s") == 0);
+#endif
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers
@@ -0,0 +1,92 @@
+/*
+ *  Unit-tests for periodic-loop timers
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <boost/test/tools/floating_point_comparison.hpp>
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+
+#include "testdefns.hpp"
+#include "rtimers/loop.hpp"
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+
+typedef LoopTimer<ManualClock, VarBoundStats, NullLogger> QuietLoopTimer;
+
+
+TestLoop::TestLoop()
+  : BoostUT::test_suite("periodic loop timers")
+{
+  add(BOOST_TEST_CASE(steady));
+  add(BOOST_TEST_CASE(lateness));
+}
+
+
+void TestLoop::steady()
+{
+  QuietLoopTimer tmr("steady", 1e-3);
+  const unsigned iterations = 500;
+  const double eps = 1e-6;
+
+  for (unsigned i=0; i<iterations; ++i) {
+    tmr.tick();
+    ManualClock::advance(0.25e-3);
+    tmr.idle();
+    ManualClock::advance(0.75e-3);
+  }
+
+  const QuietLoopTimer::Stats& stats = tmr.getStats();
+  BOOST_CHECK_EQUAL(stats.periods.count, iterations - 1);
+  BOOST_CHECK_EQUAL(stats.busy.count, iterations);
+  BOOST_CHECK_CLOSE(stats.periods.mean, 1e-3, eps);
+  BOOST_CHECK_CLOSE(stats.busy.mean, 0.25e-3, eps);
+  BOOST_CHECK_EQUAL(stats.misses, 0);
+  BOOST_CHECK_EQUAL(stats.lateness[0], iterations - 1);
+}
+
+
+void TestLoop::lateness()
+{
+  QuietLoopTimer tmr("jittery", 1e-3, 0.1e-3);
+  const double overruns[] = { 0.0, 0.02e-3, 0.05e-3, 0.2e-3, 0.5e-3,
+                              2e-3, 5e-3 };
+  const unsigned nOverruns = sizeof(overruns) / sizeof(overruns[0]);
+
+  tmr.tick();
+  for (unsigned i=0; i<nOverruns; ++i) {
+    ManualClock::advance(1e-3 + overruns[i]);
+    tmr.tick();
+  }
+
+  const QuietLoopTimer::Stats& stats = tmr.getStats();
+  BOOST_CHECK_EQUAL(stats.periods.count, nOverruns);
+  BOOST_CHECK_EQUAL(stats.misses, 4);
+  for (unsigned i=0; i<QuietLoopTimer::Stats::NBINS; ++i) {
+    BOOST_CHECK_EQUAL(stats.lateness[i], 1);
+  }
+
+  std::stringstream report;
+  report << stats;
+  BOOST_CHECK(report.str().find("misses = 4") != std::string::npos);
+  BOOST_CHECK(report.str().find(">=300%:1") != std::string::npos);
+
+  tmr.restart();
+  ManualClock::advance(1.0);
+  tmr.tick();
+  BOOST_CHECK_EQUAL(tmr.getStats().periods.count, nOverruns);
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers
@@ -10,9 +10,15 @@
 
 #include <boost/test/tools/floating_point_comparison.hpp>
 #include <boost/test/unit_test.hpp>
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <sstream>
 
 #include "rtimers/core.hpp"
+#include "rtimers/heatmap.hpp"
+#include "rtimers/omission.hpp"
+#include "rtimers/warmup.hpp"
 #include "testdefns.hpp"
 
 namespace BoostUT = boost::unit_test;
@@ -21,6 +27,8 @@ namespace BoostUT = boost::unit_test;
 namespace rtimers {
   namespace testing {
 
+ManualClock::Instant ManualClock::current = 0.0;
+std::vector<std::string> CollectingLogger::rows;
 
 struct TestStartStop : BoostUT::test_suite
 {
@@ -163,6 +171,235 @@ struct TestLogVarianceStats : BoostUT::test_suite
 };
 
 
+struct TestWarmupStats : BoostUT::test_suite
+{
+  TestWarmupStats()
+    : BoostUT::test_suite("cold-start/steady-state separation")
+  {
+    add(BOOST_TEST_CASE(fixed));
+    add(BOOST_TEST_CASE(stabilising));
+  }
+
+  static void fixed() {
+    WarmupStats<VarBoundStats, 10> stats;
+    const double eps = 1e-9;
+
+    for (unsigned i=0; i<30; ++i) {
+      stats.addSample(i < 10 ? 1.0 : 0.1);
+      BOOST_CHECK_EQUAL(stats.isSteady(), (i >= 9));
+    }
+
+    BOOST_CHECK_EQUAL(stats.count, 30);
+    BOOST_CHECK_EQUAL(stats.coldStart.count, 10);
+    BOOST_CHECK_EQUAL(stats.steadyState.count, 20);
+    BOOST_CHECK_CLOSE(stats.coldStart.mean, 1.0, eps);
+    BOOST_CHECK_CLOSE(stats.steadyState.mean, 0.1, eps);
+  }
+
+  static void stabilising() {
+    WarmupStats<VarBoundStats> stats;
+    const unsigned count = 2000;
+
+    for (unsigned i=0; i<count; ++i) {
+      const double decay = 20 * std::exp(-(double)i / 30);
+      stats.addSample(1e-6 * (1.0 + decay + 0.02 * std::sin(1.7 * i)));
+    }
+
+    BOOST_CHECK(stats.isSteady());
+    BOOST_CHECK_EQUAL(stats.count, count);
+    BOOST_CHECK_GE(stats.coldStart.count, 64);
+    BOOST_CHECK_LE(stats.coldStart.count, 400);
+    BOOST_CHECK_EQUAL(stats.coldStart.count + stats.steadyState.count, count);
+
+    BOOST_CHECK_CLOSE(stats.steadyState.mean, 1e-6, 1.0);
+    BOOST_CHECK_GT(stats.coldStart.mean, 2e-6);
+    BOOST_CHECK_LT(stats.steadyState.tmax, 1.1e-6);
+  }
+};
+
+
+struct TestHeatmapStats : BoostUT::test_suite
+{
+  typedef HeatmapStats<ManualClock, 4, 48, 8> Heatmap;
+  typedef Timer<SerialManager<ManualClock, Heatmap>, NullLogger> HeatmapTimer;
+
+  TestHeatmapStats()
+    : BoostUT::test_suite("time-resolved latency heatmaps")
+  {
+    add(BOOST_TEST_CASE(buckets));
+    add(BOOST_TEST_CASE(slices));
+    add(BOOST_TEST_CASE(exports));
+  }
+
+  static void buckets() {
+    BOOST_CHECK_EQUAL(Heatmap::bucketIndex(0.0), 0);
+    BOOST_CHECK_EQUAL(Heatmap::bucketIndex(0.9e-9), 0);
+    BOOST_CHECK_EQUAL(Heatmap::bucketIndex(1.1e-9), 0);
+    BOOST_CHECK_EQUAL(Heatmap::bucketIndex(1.1e-6), 12);
+    BOOST_CHECK_EQUAL(Heatmap::bucketIndex(2e-3), 25);
+    BOOST_CHECK_EQUAL(Heatmap::bucketIndex(1e6), 47);
+    BOOST_CHECK_CLOSE(Heatmap::bucketEdge(12), 1e-6, 1e-9);
+  }
+
+  static void slices() {
+    HeatmapTimer tmr("spiky");
+    const double period = 0.1;
+
+    // Fast calls, with a slow call every 2s, over 6s:
+    for (unsigned i=0; i<60; ++i) {
+      const double busy = (i % 20 == 10 ? 50e-3 : 20e-6);
+      tmr.start();
+      ManualClock::advance(busy);
+      tmr.stop();
+      ManualClock::advance(period - busy);
+
+      // Keep subsequent samples away from slice boundaries:
+      if (i == 0) ManualClock::advance(0.5 * period);
+    }
+
+    const Heatmap& stats = tmr.getStats();
+    const unsigned fast = Heatmap::bucketIndex(20e-6);
+    const unsigned slow = Heatmap::bucketIndex(50e-3);
+    BOOST_CHECK_EQUAL(stats.count, 60);
+    BOOST_REQUIRE_EQUAL(stats.getSlices(), 6);
+    BOOST_CHECK_EQUAL(stats.getSliceWidth(), 1.0);
+
+    for (size_t s=0; s<6; ++s) {
+      BOOST_CHECK_EQUAL(stats.getCount(s, slow), (s % 2 == 1 ? 1 : 0));
+      BOOST_CHECK_EQUAL(stats.getCount(s, fast), (s % 2 == 1 ? 9 : 10));
+    }
+
+    // Extending beyond 8 slices should merge adjacent slices:
+    ManualClock::advance(4.0);
+    tmr.start();
+    ManualClock::advance(20e-6);
+    tmr.stop();
+
+    BOOST_REQUIRE_EQUAL(stats.getSlices(), 6);
+    BOOST_CHECK_EQUAL(stats.getSliceWidth(), 2.0);
+    BOOST_CHECK_EQUAL(stats.getCount(0, fast), 19);
+    BOOST_CHECK_EQUAL(stats.getCount(0, slow), 1);
+    BOOST_CHECK_EQUAL(stats.getCount(3, fast), 0);
+    BOOST_CHECK_EQUAL(stats.getCount(5, fast), 1);
+  }
+
+  static void exports() {
+    Heatmap stats;
+    stats.setSliceWidth(0.5);
+
+    stats.addSample(3e-6, 10.0);
+    stats.addSample(3e-6, 10.2);
+    stats.addSample(4e-3, 11.1);
+
+    std::ostringstream csv;
+    stats.writeCSV(csv);
+    std::istringstream lines(csv.str());
+    std::string line;
+    unsigned nLines = 0;
+    while (std::getline(lines, line)) {
+      BOOST_CHECK_EQUAL(std::count(line.begin(), line.end(), ','), 48);
+      ++nLines;
+    }
+    BOOST_CHECK_EQUAL(nLines, 4);
+    BOOST_CHECK(csv.str().find("\n0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,0,")
+                != std::string::npos);
+
+    std::ostringstream bin;
+    stats.writeBinary(bin);
+    const std::string raw = bin.str();
+    BOOST_REQUIRE_EQUAL(raw.size(), 4 + 3*4 + 2*8 + 3*48*4);
+    BOOST_CHECK_EQUAL(raw.substr(0, 4), "RTHM");
+
+    uint32_t header[3];
+    double scales[2];
+    uint32_t last;
+    std::memcpy(header, raw.data() + 4, sizeof(header));
+    std::memcpy(scales, raw.data() + 16, sizeof(scales));
+    std::memcpy(&last, raw.data() + 32 + (2*48 + Heatmap::bucketIndex(4e-3)) * 4,
+                sizeof(last));
+    BOOST_CHECK_EQUAL(header[0], 3);
+    BOOST_CHECK_EQUAL(header[1], 48);
+    BOOST_CHECK_EQUAL(header[2], 4);
+    BOOST_CHECK_EQUAL(scales[0], 0.5);
+    BOOST_CHECK_EQUAL(last, 1);
+  }
+};
+
+
+struct TestOmissionStats : BoostUT::test_suite
+{
+  TestOmissionStats()
+    : BoostUT::test_suite("coordinated-omission correction")
+  {
+    add(BOOST_TEST_CASE(backfill));
+    add(BOOST_TEST_CASE(timed));
+    add(BOOST_TEST_CASE(limited));
+  }
+
+  static void backfill() {
+    OmissionCorrectedStats<VarBoundStats> stats(1e-3);
+    const double eps = 1e-6;
+
+    for (unsigned i=0; i<90; ++i) stats.addSample(0.1e-3);
+    stats.addSample(1.5e-3);
+    stats.addSample(10e-3);
+
+    BOOST_CHECK_EQUAL(stats.raw.count, 92);
+    BOOST_CHECK_EQUAL(stats.backfilled, 9);
+    BOOST_CHECK_EQUAL(stats.corrected.count, 101);
+    BOOST_CHECK_CLOSE(stats.raw.tmax, 10e-3, eps);
+    BOOST_CHECK_CLOSE(stats.corrected.tmax, 10e-3, eps);
+    BOOST_CHECK_CLOSE(stats.corrected.mean,
+                      (9e-3 + 1.5e-3 + 55e-3) / 101, eps);
+    BOOST_CHECK_CLOSE(stats.raw.mean, (9e-3 + 1.5e-3 + 10e-3) / 92, eps);
+
+    std::ostringstream report;
+    report << stats;
+    BOOST_CHECK(report.str().find("raw: ") == 0);
+    BOOST_CHECK(report.str().find("; corrected: ") != std::string::npos);
+    BOOST_CHECK(report.str().find("backfilled = 9, T = 1ms") != std::string::npos);
+  }
+
+  static void timed() {
+    typedef OmissionCorrectedStats<MeanBoundStats> Stats;
+    Timer<SerialManager<ManualClock, Stats>, NullLogger> tmr("requests");
+
+    tmr.getStats().setInterval(0.25);
+    for (unsigned i=0; i<4; ++i) {
+      tmr.start();
+      ManualClock::advance(i < 3 ? 0.125 : 1.0);
+      tmr.stop();
+    }
+
+    const Stats& stats = tmr.getStats();
+    BOOST_CHECK_EQUAL(stats.raw.count, 4);
+    BOOST_CHECK_EQUAL(stats.corrected.count, 7);
+    BOOST_CHECK_CLOSE(stats.corrected.mean, (0.375 + 2.5) / 7, 1e-6);
+  }
+
+  static void limited() {
+    OmissionCorrectedStats<VarBoundStats> stats(1e-6);
+
+    // A stall of 1e7 intervals should not add 1e7 samples:
+    stats.addSample(10.0);
+    BOOST_CHECK_EQUAL(stats.backfilled, 1024);
+    BOOST_CHECK_EQUAL(stats.truncated, 9999999 - 1024);
+    BOOST_CHECK_EQUAL(stats.corrected.count, 1025);
+    BOOST_CHECK_CLOSE(stats.corrected.mean, 5.0, 1.0);
+    BOOST_CHECK_GE(stats.corrected.tmin, 0.0);
+
+    std::ostringstream report;
+    report << stats;
+    BOOST_CHECK(report.str().find("truncated = 9998975") != std::string::npos);
+
+    stats.setBackfillLimit(0);
+    stats.addSample(1.0);
+    BOOST_CHECK_EQUAL(stats.backfilled, 1024);
+    BOOST_CHECK_EQUAL(stats.corrected.count, 1026);
+  }
+};
+
+
 struct RTtestSuite : BoostUT::test_suite
 {
   RTtestSuite()
@@ -171,10 +408,32 @@ struct RTtestSuite : BoostUT::test_suite
     add(new TestStartStop);
     add(new TestVarianceStats);
     add(new TestLogVarianceStats);
+    add(new TestWarmupStats);
+    add(new TestHeatmapStats);
+    add(new TestOmissionStats);
 
+    add(new TestAdmission);
+    add(new TestAutotune);
     add(new TestBoost);
+    add(new TestClockCheck);
+    add(new TestControl);
     add(new TestCxx11);
+    add(new TestEndpoint);
+    add(new TestFtrace);
+    add(new TestInstrument);
+    add(new TestLoadGen);
+    add(new TestLoop);
+    add(new TestParallel);
+    add(new TestPatch);
     add(new TestPosix);
+    add(new TestRegistry);
+    add(new TestRotating);
+    add(new TestSampling);
+    add(new TestSelector);
+    add(new TestStall);
+    add(new TestStartup);
+    add(new TestUring);
+    add(new TestUsdt);
   }
 };
 
@@ -0,0 +1,108 @@
+/*
+ *  Unit-tests for parallel-region load-imbalance timers
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <boost/test/tools/floating_point_comparison.hpp>
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+
+#include "testdefns.hpp"
+
+#if RTIMERS_HAVE_CXX11
+#  include <chrono>
+#  include <thread>
+#  include <vector>
+#  include "rtimers/cxx11.hpp"
+#  include "rtimers/parallel.hpp"
+#endif
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+
+TestParallel::TestParallel()
+  : BoostUT::test_suite("parallel-region timers")
+{
+  add(BOOST_TEST_CASE(simulated));
+  add(BOOST_TEST_CASE(threaded));
+}
+
+
+void TestParallel::simulated()
+{
+#if RTIMERS_HAVE_CXX11
+  typedef ParallelRegionTimer<ManualClock, VarBoundStats, NullLogger> Region;
+  Region tmr("simulated", 4);
+  const double eps = 1e-6;
+
+  for (unsigned instance=0; instance<3; ++instance) {
+    // Threads start at 0, 0.1, 0.2, 0.3ms, and finish at 1, 2, 3, 4ms:
+    Region::Instant starts[4];
+    for (unsigned t=0; t<4; ++t) {
+      starts[t] = tmr.enter();
+      ManualClock::advance(0.1e-3);
+    }
+    ManualClock::advance(0.6e-3);
+    for (unsigned t=0; t<4; ++t) {
+      tmr.leave(starts[t]);
+      ManualClock::advance(1e-3);
+    }
+    BOOST_CHECK_EQUAL(tmr.getStats().instances, instance + 1);
+  }
+
+  const Region::Stats& stats = tmr.getStats();
+  BOOST_CHECK_EQUAL(stats.maxTime.count, 3);
+  BOOST_CHECK_CLOSE(stats.maxTime.mean, 3.7e-3, eps);
+  BOOST_CHECK_CLOSE(stats.minTime.mean, 1.0e-3, eps);
+  BOOST_CHECK_CLOSE(stats.meanTime.mean, 2.35e-3, eps);
+  BOOST_CHECK_CLOSE(stats.imbalance.mean, 3.7 / 2.35, eps);
+  BOOST_CHECK_CLOSE(stats.wasted.mean, 6e-3, eps);
+
+  std::ostringstream report;
+  report << stats;
+  BOOST_CHECK(report.str().find("wasted: <t> = 6ms") != std::string::npos);
+  BOOST_CHECK(report.str().find("imbalance = 1.57") != std::string::npos);
+#endif
+}
+
+
+void TestParallel::threaded()
+{
+#if RTIMERS_HAVE_CXX11
+  typedef ParallelRegionTimer<cxx11::HiResClock,
+                              VarBoundStats, NullLogger> Region;
+  const unsigned nThreads = 4, nInstances = 3;
+  Region tmr("threaded", nThreads);
+
+  for (unsigned instance=0; instance<nInstances; ++instance) {
+    std::vector<std::thread> team;
+    for (unsigned t=0; t<nThreads; ++t) {
+      team.push_back(std::thread([&tmr, t]() {
+        Region::Scoper scope = tmr.scopedEnter();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2 + 6 * (t == 0)));
+      }));
+    }
+    for (auto& thr : team) thr.join();
+  }
+
+  const Region::Stats& stats = tmr.getStats();
+  BOOST_CHECK_EQUAL(stats.instances, nInstances);
+  BOOST_CHECK_GE(stats.maxTime.tmin, 8e-3);
+  BOOST_CHECK_GE(stats.minTime.tmin, 2e-3);
+  BOOST_CHECK_GT(stats.imbalance.mean, 1.3);
+  BOOST_CHECK_GT(stats.wasted.mean, 10e-3);
+#endif
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers
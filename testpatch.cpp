@@ -0,0 +1,189 @@
+/*
+ *  Unit-tests for run-time patched function timing
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+#include <boost/test/tools/floating_point_comparison.hpp>
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include <thread>
+
+#include "testdefns.hpp"
+#include "rtimers/patch.hpp"
+#include "rtimers/registry.hpp"
+
+// Equivalent to compiling with -fpatchable-function-entry=5:
+#if defined(__clang__)
+#  define RTIMERS_TEST_PATCHABLE \
+    __attribute__((noinline, patchable_function_entry(5)))
+#else
+#  define RTIMERS_TEST_PATCHABLE \
+    __attribute__((noipa, patchable_function_entry(5)))
+#endif
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+
+RTIMERS_TEST_PATCHABLE
+double patchTargetMixed(int a, double b, long c, double d,
+                        int e, int f, int g, long h)
+{
+  double tot = 0.0;
+
+  for (int i=0; i<a; ++i) {
+    tot += std::sin(b * i) + d;
+  }
+
+  return tot + c + e + f + g + h;
+}
+
+
+RTIMERS_TEST_PATCHABLE
+long patchTargetShort(long x)
+{
+  return 3 * x + 1;
+}
+
+
+void ignoreSignal(int) {}
+
+
+TestPatch::TestPatch()
+  : BoostUT::test_suite("run-time function patching")
+{
+  add(BOOST_TEST_CASE(signals));
+  add(BOOST_TEST_CASE(toggling));
+  add(BOOST_TEST_CASE(concurrent));
+}
+
+
+void TestPatch::signals()
+{
+  // Patching must not displace an application's handler:
+  const char* name = "rtimers::testing::patchTargetShort";
+  const int taken = SIGRTMAX - 3;
+
+  if (!patch::isSupported()) return;
+
+  struct sigaction action, previous;
+  std::memset(&action, 0, sizeof(action));
+  action.sa_handler = &ignoreSignal;
+  sigemptyset(&action.sa_mask);
+  BOOST_REQUIRE_EQUAL(sigaction(taken, &action, &previous), 0);
+
+  BOOST_CHECK(!patch::patchFunction(name));
+  BOOST_CHECK(!patch::setScrubSignal(0));
+  BOOST_CHECK(patch::setScrubSignal(SIGRTMAX - 4));
+  BOOST_CHECK(patch::patchFunction(name));
+  BOOST_CHECK_EQUAL(patchTargetShort(5), 16);
+  BOOST_CHECK(patch::unpatchFunction(name));
+  BOOST_CHECK(!patch::setScrubSignal(taken));
+
+  struct sigaction current;
+  BOOST_REQUIRE_EQUAL(sigaction(taken, &previous, &current), 0);
+  BOOST_CHECK(current.sa_handler == &ignoreSignal);
+}
+
+
+void TestPatch::toggling()
+{
+  const char* name = "rtimers::testing::patchTargetMixed";
+  const double expected = patchTargetMixed(40, 0.3, 5, 0.25, 6, 7, 8, 9);
+  const double eps = 1e-9;
+
+  if (!patch::isSupported()) {
+    BOOST_TEST_MESSAGE("Run-time patching not supported");
+    return;
+  }
+
+  const std::vector<std::string> patchable = patch::listPatchable();
+  BOOST_CHECK(std::find(patchable.begin(), patchable.end(),
+                        "rtimers::testing::patchTargetMixed(int, double, long, double, int, int, int, long)")
+                != patchable.end());
+
+  BOOST_CHECK(!patch::patchFunction("rtimers::testing::noSuchFunction"));
+  BOOST_CHECK(!patch::unpatchFunction(name));
+
+  BOOST_REQUIRE(patch::patchFunction(name));
+  BOOST_CHECK(patch::patchFunction(name));
+  for (unsigned i=0; i<25; ++i) {
+    BOOST_CHECK_CLOSE(patchTargetMixed(40, 0.3, 5, 0.25, 6, 7, 8, 9),
+                      expected, eps);
+  }
+
+  BOOST_REQUIRE(patch::unpatchFunction(name));
+  for (unsigned i=0; i<10; ++i) {
+    BOOST_CHECK_CLOSE(patchTargetMixed(40, 0.3, 5, 0.25, 6, 7, 8, 9),
+                      expected, eps);
+  }
+
+  BOOST_REQUIRE(patch::patchFunction(name));
+  BOOST_CHECK_CLOSE(patchTargetMixed(40, 0.3, 5, 0.25, 6, 7, 8, 9),
+                    expected, eps);
+  BOOST_CHECK(patch::unpatchFunction(name));
+
+  const std::vector<patch::PatchedStats> functions = patch::collect();
+  const auto mixed = std::find_if(functions.begin(), functions.end(),
+                                  [name](const patch::PatchedStats& fn) {
+                                    return fn.name == name; });
+  BOOST_REQUIRE(mixed != functions.end());
+  BOOST_CHECK(!mixed->active);
+  BOOST_CHECK_EQUAL(mixed->stats.count, 26);
+  BOOST_CHECK_GT(mixed->stats.mean, 0.0);
+  BOOST_CHECK_LT(mixed->stats.tmax, 0.1);
+
+  const RegistryEntry& timer = Registry::global().lookup(name);
+  BOOST_CHECK_EQUAL(timer.read().count, 26);
+}
+
+
+void TestPatch::concurrent()
+{
+  // Repeatedly patch a function while other threads are calling it:
+  const char* name = "rtimers::testing::patchTargetShort";
+  const unsigned nthreads = 3, ntoggles = 100;
+
+  if (!patch::isSupported()) return;
+
+  std::atomic<bool> running(true);
+  std::atomic<unsigned> errors(0);
+  std::atomic<unsigned long> calls(0);
+  std::vector<std::thread> callers;
+
+  for (unsigned t=0; t<nthreads; ++t) {
+    callers.push_back(std::thread([&]() {
+      for (long i=0; running.load(); ++i) {
+        if (patchTargetShort(i) != 3 * i + 1) ++errors;
+        ++calls;
+      }
+    }));
+  }
+
+  unsigned toggled = 0;
+  for (unsigned i=0; i<ntoggles; ++i) {
+    if (patch::patchFunction(name) && patch::unpatchFunction(name)) ++toggled;
+  }
+  running = false;
+  for (auto& caller : callers) caller.join();
+
+  BOOST_CHECK_EQUAL(toggled, ntoggles);
+  BOOST_CHECK_EQUAL(errors.load(), 0);
+  BOOST_CHECK_GT(calls.load(), 0);
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers
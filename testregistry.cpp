@@ -0,0 +1,335 @@
+/*
+ *  Unit-tests for the registry of named timers
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <boost/test/tools/floating_point_comparison.hpp>
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "testdefns.hpp"
+
+#if RTIMERS_HAVE_CXX11
+#  include "rtimers/registry.hpp"
+#endif
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+#if RTIMERS_HAVE_CXX11
+
+typedef Timer<RegisteredManager<SerialManager<ManualClock, MeanBoundStats> >,
+              NullLogger> RegisteredTimer;
+
+static void occupy(RegisteredTimer& tmr, unsigned count, double dt)
+{
+  for (unsigned i=0; i<count; ++i) {
+    tmr.start();
+    ManualClock::advance(dt);
+    tmr.stop();
+  }
+}
+
+#endif  // RTIMERS_HAVE_CXX11
+
+
+TestRegistry::TestRegistry()
+  : BoostUT::test_suite("timer registry")
+{
+  add(BOOST_TEST_CASE(histogram));
+  add(BOOST_TEST_CASE(entries));
+  add(BOOST_TEST_CASE(shards));
+  add(BOOST_TEST_CASE(threads));
+  add(BOOST_TEST_CASE(transient));
+  add(BOOST_TEST_CASE(snapshots));
+}
+
+
+void TestRegistry::histogram()
+{
+#if RTIMERS_HAVE_CXX11
+  HistogramStats early, late;
+  const double eps = 1e-6;
+
+  for (unsigned i=0; i<90; ++i) early.addSample(2e-6);
+  for (unsigned i=0; i<10; ++i) early.addSample(3e-3);
+  BOOST_CHECK_CLOSE(early.getMean(), (90 * 2e-6 + 10 * 3e-3) / 100, eps);
+  BOOST_CHECK_LT(early.percentile(0.5), 2.5e-6);
+  BOOST_CHECK_GT(early.percentile(0.5), 1.7e-6);
+  BOOST_CHECK_GT(early.percentile(0.95), 1.7e-3);
+  BOOST_CHECK_LE(early.percentile(0.95), 3e-3);
+  BOOST_CHECK_EQUAL(HistogramStats().percentile(0.5), 0.0);
+
+  HistogramStats merged(early);
+  for (unsigned i=0; i<50; ++i) late.addSample(40e-6);
+  merged += late;
+  BOOST_CHECK_EQUAL(merged.count, 150);
+  BOOST_CHECK_EQUAL(merged.tmin, 2e-6);
+  BOOST_CHECK_EQUAL(merged.tmax, 3e-3);
+
+  const HistogramStats delta = merged.since(early);
+  BOOST_CHECK_EQUAL(delta.count, 50);
+  BOOST_CHECK_CLOSE(delta.getMean(), 40e-6, eps);
+  BOOST_CHECK_LE(delta.tmin, 40e-6);
+  BOOST_CHECK_GE(delta.tmax, 40e-6);
+  BOOST_CHECK_LT(delta.tmax / delta.tmin, 1.8);
+#endif
+}
+
+
+void TestRegistry::entries()
+{
+#if RTIMERS_HAVE_CXX11
+  Registry registry;
+
+  RegistryEntry& first = registry.lookup("first");
+  RegistryEntry& second = registry.lookup("second");
+  BOOST_CHECK_EQUAL(first.id, 0);
+  BOOST_CHECK_EQUAL(second.id, 1);
+  BOOST_CHECK_EQUAL(&registry.lookup("first"), &first);
+  BOOST_CHECK_EQUAL(&registry.at(1), &second);
+  BOOST_CHECK_EQUAL(registry.size(), 2);
+
+  second.addSample(1e-3);
+  second.addSample(3e-3);
+  BOOST_CHECK_EQUAL(second.read().count, 2);
+  BOOST_CHECK_CLOSE(second.read().getMean(), 2e-3, 1e-6);
+
+  registry.reset();
+  BOOST_CHECK_EQUAL(second.read().count, 0);
+  BOOST_CHECK_EQUAL(registry.snapshot().timers.size(), 2);
+  BOOST_CHECK_THROW(registry.at(2), std::out_of_range);
+
+  // Shard tables of a destroyed registry should not be seen by its successor:
+  for (unsigned i=0; i<3; ++i) {
+    Registry transient;
+    RegistryEntry& entry = transient.lookup("recycled");
+    BOOST_CHECK_EQUAL(entry.read().count, 0);
+    entry.addSample(1e-3);
+    BOOST_CHECK_EQUAL(entry.read().count, 1);
+  }
+#endif
+}
+
+
+void TestRegistry::shards()
+{
+#if RTIMERS_HAVE_CXX11
+  Registry registry;
+  RegistryEntry& entry = registry.lookup("sharded");
+  const unsigned nThreads = 4, nSamples = 1000;
+
+  std::vector<std::thread> threads;
+  for (unsigned t=0; t<nThreads; ++t) {
+    threads.emplace_back([&entry, t]() {
+      for (unsigned i=0; i<nSamples; ++i) entry.addSample((t + 1) * 1e-6);
+    });
+  }
+
+  // Copies taken while samples are being added should be self-consistent:
+  unsigned inconsistent = 0;
+  for (unsigned r=0; r<200; ++r) {
+    const HistogramStats partial = entry.read();
+    unsigned long inBuckets = 0;
+    for (unsigned b=0; b<HistogramStats::NBUCKETS; ++b) {
+      inBuckets += partial.buckets[b];
+    }
+    if (inBuckets != partial.count) ++inconsistent;
+  }
+  BOOST_CHECK_EQUAL(inconsistent, 0);
+
+  for (auto& thread : threads) thread.join();
+  entry.addSample(1e-3);
+
+  const HistogramStats total = entry.read();
+  BOOST_CHECK_EQUAL(total.count, nThreads * nSamples + 1);
+  BOOST_CHECK_CLOSE(total.total, nSamples * 10e-6 + 1e-3, 1e-6);
+  BOOST_CHECK_EQUAL(total.tmin, 1e-6);
+  BOOST_CHECK_EQUAL(total.tmax, 1e-3);
+
+  unsigned long perNode = 0;
+  for (auto& node : entry.readByNode()) {
+    BOOST_CHECK_GE(node.first, 0);
+    perNode += node.second.count;
+  }
+  BOOST_CHECK_EQUAL(perNode, total.count);
+
+  int where = -1;
+  const void* mem = numa::LocalArena::local().allocate(64, where);
+  BOOST_CHECK_EQUAL(reinterpret_cast<size_t>(mem) % 64, 0u);
+  const int placed = numa::nodeOfAddress(mem);
+  if (placed >= 0) BOOST_CHECK_EQUAL(where, placed);
+
+  char spans[1024];
+  numa::SparePool spare;
+  numa::SparePool::Span found;
+  spare.give(spans, 512, 0);
+  spare.give(spans + 512, 128, 0);
+  BOOST_CHECK(!spare.take(100, 1, found));
+  BOOST_CHECK(!spare.take(600, 0, found));
+  BOOST_REQUIRE(spare.take(100, 0, found));
+  BOOST_CHECK_EQUAL(found.base, spans + 512);
+  BOOST_REQUIRE(spare.take(100, 0, found));
+  BOOST_CHECK_EQUAL(found.size, 512u);
+  BOOST_CHECK(!spare.take(100, 0, found));
+
+  registry.reset();
+  BOOST_CHECK_EQUAL(entry.read().count, 0);
+  entry.addSample(2e-3);
+  const HistogramStats fresh = entry.read();
+  BOOST_CHECK_EQUAL(fresh.count, 1);
+  BOOST_CHECK_CLOSE(fresh.total, 2e-3, 1e-6);
+  BOOST_CHECK_CLOSE(fresh.tmin, 2e-3, 80.0);
+  BOOST_CHECK_CLOSE(fresh.tmax, 2e-3, 80.0);
+#endif
+}
+
+
+void TestRegistry::threads()
+{
+#if RTIMERS_HAVE_CXX11
+  Registry registry;
+  RegistryEntry& entry = registry.lookup("per-thread");
+  const char* names[] = { "worker-a", "worker-b", "worker-c" };
+
+  std::vector<std::thread> threads;
+  for (unsigned t=0; t<3; ++t) {
+    threads.emplace_back([&entry, &names, t]() {
+      pthread_setname_np(pthread_self(), names[t]);
+      const double dt = (t == 1 ? 60e-6 : 20e-6);
+      for (unsigned i=0; i<100; ++i) entry.addSample(dt);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  const ThreadBreakdown breakdown(entry);
+  BOOST_REQUIRE_EQUAL(breakdown.size(), 3);
+  for (unsigned t=0; t<3; ++t) {
+    BOOST_CHECK_EQUAL(breakdown[t].thread, names[t]);
+    BOOST_CHECK_EQUAL(breakdown[t].stats.count, 100);
+    BOOST_CHECK_GT(breakdown[t].tid, 0);
+  }
+  BOOST_CHECK_CLOSE(breakdown[1].stats.getMean(), 60e-6, 1e-6);
+  BOOST_CHECK_CLOSE(breakdown.spread(), 3.0, 1e-6);
+
+  CollectingLogger::rows.clear();
+  breakdown.report<CollectingLogger>();
+  BOOST_REQUIRE_EQUAL(CollectingLogger::rows.size(), 4);
+  BOOST_CHECK_EQUAL(CollectingLogger::ident(1), "per-thread[worker-b]");
+  BOOST_CHECK_EQUAL(CollectingLogger::rows[3], "per-thread: thread spread = 3");
+#endif
+}
+
+
+void TestRegistry::transient()
+{
+#if RTIMERS_HAVE_CXX11
+  Registry registry;
+  for (unsigned i=0; i<600; ++i) {
+    std::ostringstream name;
+    name << "transient-" << i;
+    registry.lookup(name.str());
+  }
+  BOOST_CHECK_EQUAL(registry.at(599).name, "transient-599");
+  BOOST_CHECK_EQUAL(&registry.at(300), &registry.lookup("transient-300"));
+
+  RegistryEntry& entry = registry.at(257);
+  for (unsigned i=0; i<1000; ++i) {
+    RegistryScope<ManualClock> scope(entry);
+    ManualClock::advance(i % 2 ? 30e-6 : 10e-6);
+  }
+  BOOST_CHECK_EQUAL(entry.read().count, 1000);
+  BOOST_CHECK_CLOSE(entry.read().getMean(), 20e-6, 1e-3);
+
+  const unsigned id = Registry::global().lookup("registry-transient").id;
+  std::thread worker([id]() {
+    for (unsigned i=0; i<100; ++i) {
+      RegistryScope<ManualClock> scope(id);
+    }
+  });
+  worker.join();
+  BOOST_CHECK_EQUAL(Registry::global().at(id).read().count, 100);
+#endif
+}
+
+
+void TestRegistry::snapshots()
+{
+#if RTIMERS_HAVE_CXX11
+  RegisteredTimer alpha("registry-alpha"), beta("registry-beta");
+  const double eps = 1e-6;
+
+  const RegistrySnapshot start = Registry::global().snapshot();
+  occupy(alpha, 100, 1e-3);
+  occupy(beta, 200, 20e-6);
+
+  const RegistrySnapshot warm = Registry::global().snapshot();
+  occupy(alpha, 100, 5e-3);
+  occupy(beta, 100, 20e-6);
+  RegisteredTimer gamma("registry-gamma");
+  occupy(gamma, 10, 1e-3);
+
+  const RegistrySnapshot loaded = Registry::global().snapshot();
+  BOOST_CHECK_EQUAL(loaded.timers.at("registry-alpha").count, 200);
+  BOOST_CHECK_EQUAL(alpha.getStats().count, 200);
+
+  RegistryDiff diff = Registry::diff(warm, loaded);
+  diff.sortByTotal();
+  BOOST_REQUIRE_GE(diff.size(), 3);
+  BOOST_CHECK_EQUAL(diff[0].name, "registry-alpha");
+  BOOST_CHECK_EQUAL(diff[1].name, "registry-gamma");
+  BOOST_CHECK_EQUAL(diff[2].name, "registry-beta");
+
+  const TimerDelta& slower = diff[0];
+  BOOST_CHECK_EQUAL(slower.interval.count, 100);
+  BOOST_CHECK_CLOSE(slower.interval.total, 0.5, eps);
+  BOOST_CHECK_CLOSE(slower.baselineMean, 1e-3, eps);
+  BOOST_CHECK(slower.shapeChanged);
+  BOOST_CHECK_CLOSE(slower.ksStatistic, 1.0, eps);
+
+  const TimerDelta& steady = diff[2];
+  BOOST_CHECK_EQUAL(steady.interval.count, 100);
+  BOOST_CHECK(!steady.shapeChanged);
+  BOOST_CHECK(!diff[1].shapeChanged);
+
+  std::ostringstream report;
+  report << slower;
+  BOOST_CHECK_EQUAL(report.str(), "count +100, total +0.5s, <t> = 5ms "
+                                  "(was 1ms), distribution changed (D = 1)");
+
+  const RegistryDiff whole = Registry::diff(start, loaded);
+  for (auto& delta : whole) {
+    if (delta.name == "registry-alpha") {
+      BOOST_CHECK_EQUAL(delta.interval.count, 200);
+      BOOST_CHECK(!delta.shapeChanged);
+    }
+  }
+
+  // A reset between snapshots should not produce negative counts:
+  Registry::global().lookup("registry-beta").reset();
+  occupy(beta, 30, 20e-6);
+  const RegistryDiff afterReset = Registry::diff(loaded,
+                                                 Registry::global().snapshot());
+  for (auto& delta : afterReset) {
+    if (delta.name == "registry-beta") {
+      BOOST_CHECK_EQUAL(delta.interval.count, 30);
+      BOOST_CHECK_CLOSE(delta.interval.total, 30 * 20e-6, eps);
+    }
+  }
+#endif
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers
@@ -0,0 +1,230 @@
+/*
+ *  Unit-tests for rotating output files
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "testdefns.hpp"
+
+#if RTIMERS_HAVE_POSIX
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  include "rtimers/rotating.hpp"
+#endif
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+#if RTIMERS_HAVE_POSIX
+
+namespace {
+
+std::string slurp(const std::string& path)
+{
+  std::ifstream strm(path.c_str());
+  std::ostringstream content;
+  content << strm.rdbuf();
+  return content.str();
+}
+
+bool exists(const std::string& path)
+{
+  struct stat info;
+  return stat(path.c_str(), &info) == 0;
+}
+
+std::string record(unsigned idx)
+{
+  std::ostringstream strm;
+  strm << "record " << idx << " " << std::string(40, '.') << "\n";
+  return strm.str();
+}
+
+}   // namespace (anonymous)
+
+#endif  // RTIMERS_HAVE_POSIX
+
+
+TestRotating::TestRotating()
+  : BoostUT::test_suite("rotating output files")
+{
+  add(BOOST_TEST_CASE(rotation));
+  add(BOOST_TEST_CASE(freezing));
+  add(BOOST_TEST_CASE(periodic));
+  add(BOOST_TEST_CASE(restarting));
+}
+
+
+void TestRotating::rotation()
+{
+#if RTIMERS_HAVE_POSIX
+  TempDir dir("rotating");
+  BOOST_REQUIRE(!dir.path.empty());
+  const std::string base = dir.path + "/timers";
+
+  {
+    RotatingOutput out(base, 500, 3);
+    for (unsigned i=0; i<100; ++i) out.write(record(i));
+    out.flush();
+
+    const std::vector<std::string> segments = out.getSegments();
+    BOOST_REQUIRE_EQUAL(segments.size(), 3);
+    BOOST_CHECK_EQUAL(segments.back(), base + ".000010");
+    BOOST_CHECK(!exists(base + ".000007"));
+
+    for (auto& seg : segments) {
+      const std::string content = slurp(seg);
+      BOOST_CHECK_LE(content.size(), 500);
+      BOOST_CHECK_EQUAL(content.find("record "), 0);
+      BOOST_CHECK_EQUAL(content.back(), '\n');
+    }
+    BOOST_CHECK(slurp(segments.back()).find(record(99)) != std::string::npos);
+
+    // Records larger than a segment are written alone:
+    out.write(std::string(800, 'x') + "\n");
+    out.write(record(100));
+    out.flush();
+    BOOST_CHECK_EQUAL(slurp(base + ".000011").size(), 801);
+    BOOST_CHECK_EQUAL(slurp(base + ".000012"), record(100));
+  }
+
+  {
+    RotatingOutput tiny(base + "-small", 500, 3, 0.0, 100);
+    tiny.write(record(0));
+    tiny.write(record(1));
+    tiny.write(record(2));
+    BOOST_CHECK_EQUAL(tiny.dropped(), 1);
+  }
+#endif
+}
+
+
+void TestRotating::freezing()
+{
+#if RTIMERS_HAVE_POSIX
+  TempDir dir("rotating");
+  BOOST_REQUIRE(!dir.path.empty());
+  const std::string base = dir.path + "/incident";
+
+  RotatingOutput out(base, 500, 2);
+  for (unsigned i=0; i<30; ++i) out.write(record(i));
+  out.flush();
+  BOOST_CHECK_EQUAL(out.getSegments().size(), 2);
+
+  out.freeze();
+  for (unsigned i=30; i<100; ++i) out.write(record(i));
+  out.flush();
+
+  const std::vector<std::string> frozen = out.getFrozen();
+  BOOST_REQUIRE_EQUAL(frozen.size(), 2);
+  BOOST_CHECK_EQUAL(frozen[0], base + ".frozen.000002");
+  BOOST_CHECK(slurp(frozen[1]).find(record(29)) != std::string::npos);
+  BOOST_CHECK_EQUAL(out.getSegments().size(), 2);
+  BOOST_CHECK(slurp(frozen[1]).find(record(30)) == std::string::npos);
+
+  // Records still queued when freezing should be preserved with the rest:
+  out.write(record(100));
+  out.freeze();
+  out.write(record(101));
+  out.flush();
+
+  const std::vector<std::string> refrozen = out.getFrozen();
+  BOOST_REQUIRE_EQUAL(refrozen.size(), 4);
+  BOOST_CHECK(slurp(refrozen.back()).find(record(100)) != std::string::npos);
+  BOOST_CHECK(slurp(refrozen.back()).find(record(101)) == std::string::npos);
+  BOOST_CHECK(slurp(out.getSegments().back()).find(record(101))
+                != std::string::npos);
+#endif
+}
+
+
+void TestRotating::periodic()
+{
+#if RTIMERS_HAVE_POSIX
+  TempDir dir("rotating");
+  BOOST_REQUIRE(!dir.path.empty());
+  const std::string base = dir.path + "/periodic";
+
+  Registry registry;
+  registry.lookup("rotating-periodic").addSample(1e-3);
+
+  RotatingOutput out(base, 4096, 4);
+  RotatingLogger::setOutput(&out);
+  RotatingLogger::report("direct", MeanBoundStats());
+  out.dumpPeriodically(registry, 0.02);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  out.flush();
+  RotatingLogger::setOutput(nullptr);
+
+  const std::string content = slurp(base + ".000000");
+  BOOST_CHECK_EQUAL(content.find("Timer(direct): "), 0);
+  BOOST_CHECK(content.find("Timer(rotating-periodic): <t> = 1ms")
+              != std::string::npos);
+#endif
+}
+
+
+void TestRotating::restarting()
+{
+#if RTIMERS_HAVE_POSIX
+  TempDir dir("rotating");
+  BOOST_REQUIRE(!dir.path.empty());
+  const std::string base = dir.path + "/restart";
+
+  {
+    RotatingOutput first(base, 500, 3);
+    for (unsigned i=0; i<20; ++i) first.write(record(i));
+    first.flush();
+    first.freeze();
+    first.flush();
+    BOOST_CHECK_EQUAL(first.getFrozen().size(), 3);
+    first.write(record(20));
+    first.flush();
+  }
+  BOOST_CHECK_EQUAL(slurp(base + ".000003"), record(20));
+
+  {
+    // A later process should neither overwrite nor forget earlier segments:
+    RotatingOutput second(base, 500, 3);
+    BOOST_CHECK_EQUAL(second.getSegments().size(), 1);
+    second.write(record(21));
+    second.flush();
+
+    const std::vector<std::string> segments = second.getSegments();
+    BOOST_REQUIRE_EQUAL(segments.size(), 2);
+    BOOST_CHECK_EQUAL(segments.back(), base + ".000004");
+    BOOST_CHECK_EQUAL(slurp(base + ".000003"), record(20));
+
+    // Freezing must not replace a segment frozen earlier:
+    std::ofstream(base + ".frozen.000004") << "incident\n";
+    second.freeze();
+    second.flush();
+    const std::vector<std::string> frozen = second.getFrozen();
+    BOOST_REQUIRE_EQUAL(frozen.size(), 2);
+    BOOST_CHECK_EQUAL(frozen[0], base + ".frozen.000003");
+    BOOST_CHECK_EQUAL(frozen[1], base + ".frozen.000004-1");
+    BOOST_CHECK_EQUAL(slurp(base + ".frozen.000004"), "incident\n");
+    BOOST_CHECK_EQUAL(slurp(frozen[1]), record(21));
+
+    Registry registry;
+    BOOST_CHECK(!second.dumpPeriodically(registry, 0.0));
+    BOOST_CHECK(!second.dumpPeriodically(registry, -1.0));
+  }
+#endif
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers
@@ -0,0 +1,162 @@
+/*
+ *  Unit-tests for the SIGPROF sampling profiler
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <sstream>
+
+#include "testdefns.hpp"
+
+#if RTIMERS_HAVE_POSIX
+#  include "rtimers/cxx11.hpp"
+#  include "rtimers/sampling.hpp"
+#endif
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+#if RTIMERS_HAVE_POSIX
+
+typedef Timer<sampling::ScopeStackManager<SerialManager<cxx11::HiResClock,
+                                                        MeanBoundStats> >,
+              NullLogger> ProfiledTimer;
+
+//! Consume CPU time for (at least) a given duration
+__attribute__((noinline))
+double sampledBusyLoop(double duration)
+{
+  const auto start = cxx11::HiResClock::now();
+  double tot = 0.0;
+  unsigned i = 0;
+
+  while (cxx11::HiResClock::interval(start, cxx11::HiResClock::now()) < duration) {
+    tot += std::sqrt(1.0 + (i++ % 97));
+  }
+
+  return tot;
+}
+
+#endif  // RTIMERS_HAVE_POSIX
+
+
+TestSampling::TestSampling()
+  : BoostUT::test_suite("SIGPROF sampling profiler")
+{
+  add(BOOST_TEST_CASE(scopes));
+  add(BOOST_TEST_CASE(stacking));
+}
+
+
+void TestSampling::scopes()
+{
+#if RTIMERS_HAVE_POSIX
+  using sampling::SamplingProfiler;
+
+  SamplingProfiler::reset();
+  BOOST_REQUIRE(SamplingProfiler::start(1000.0));
+  BOOST_REQUIRE(SamplingProfiler::attachThread());
+
+  double tot = 0.0;
+  { ProfiledTimer outer("outer"), inner("inner");
+
+    { ProfiledTimer::Scoper so = outer.scopedStart();
+      tot += sampledBusyLoop(0.05);
+      { ProfiledTimer::Scoper si = inner.scopedStart();
+        tot += sampledBusyLoop(0.15);
+      }
+    }
+    tot += sampledBusyLoop(0.05);
+  }
+
+  SamplingProfiler::detachThread();
+  SamplingProfiler::stop();
+  BOOST_CHECK(tot > 0.0);
+
+  const std::map<std::string, sampling::ScopeProfile> profiles =
+                                          SamplingProfiler::collect(3);
+  BOOST_REQUIRE(profiles.count("inner") == 1);
+  BOOST_REQUIRE(profiles.count("outer") == 1);
+
+  const sampling::ScopeProfile& inner = profiles.find("inner")->second;
+  const sampling::ScopeProfile& outer = profiles.find("outer")->second;
+  BOOST_CHECK_GT(inner.samples, outer.samples);
+  BOOST_CHECK_GT(outer.samples, 5);
+  BOOST_CHECK_GT(SamplingProfiler::unattributed(), 5);
+  BOOST_CHECK_EQUAL(SamplingProfiler::dropped(), 0);
+
+  BOOST_REQUIRE(!inner.hotspots.empty());
+  BOOST_CHECK_LE(inner.hotspots.size(), 3);
+
+  std::stringstream report;
+  report << inner;
+  BOOST_CHECK(report.str().find("samples = ") == 0);
+
+  SamplingProfiler::reset();
+  BOOST_CHECK(SamplingProfiler::collect().empty());
+#else
+  BOOST_ERROR("No POSIX timer support");
+#endif  // RTIMERS_HAVE_POSIX
+}
+
+
+void TestSampling::stacking()
+{
+#if RTIMERS_HAVE_POSIX
+  using sampling::SamplingProfiler;
+  using sampling::ScopeStack;
+
+  // Timers stopped out of order should leave the correct innermost scope:
+  ScopeStack stack = { { NULL }, 0 };
+  const std::string* a = ScopeStack::intern("stack-a");
+  const std::string* b = ScopeStack::intern("stack-b");
+  const std::string* c = ScopeStack::intern("stack-c");
+
+  stack.push(a);
+  stack.push(b);
+  stack.push(c);
+  stack.pop(b);
+  BOOST_CHECK_EQUAL(stack.depth, 2);
+  BOOST_CHECK_EQUAL(stack.top(), c);
+  stack.pop(c);
+  BOOST_CHECK_EQUAL(stack.top(), a);
+  stack.pop(a);
+  BOOST_CHECK(stack.top() == NULL);
+  stack.pop(a);
+  BOOST_CHECK_EQUAL(stack.depth, 0);
+
+  // Labels which are not on the stack should not disturb it:
+  stack.push(a);
+  stack.push(b);
+  stack.pop(c);
+  BOOST_CHECK_EQUAL(stack.depth, 2);
+  BOOST_CHECK_EQUAL(stack.top(), b);
+  stack.pop(b);
+  BOOST_CHECK_EQUAL(stack.top(), a);
+
+  // Stopping should restore the application's own SIGPROF disposition:
+  struct sigaction action;
+  BOOST_REQUIRE(SamplingProfiler::start(100.0));
+  SamplingProfiler::stop();
+  BOOST_REQUIRE_EQUAL(sigaction(SIGPROF, NULL, &action), 0);
+  BOOST_CHECK(action.sa_handler == SIG_DFL);
+
+  // Threads cannot be attached while the profiler is stopped:
+  SamplingProfiler::stop();
+  BOOST_CHECK(!SamplingProfiler::attachThread());
+  BOOST_CHECK(!SamplingProfiler::start(0.0));
+#endif  // RTIMERS_HAVE_POSIX
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers
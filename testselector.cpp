@@ -0,0 +1,160 @@
+/*
+ *  Unit-tests for run-time selection between implementations
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+#include "testdefns.hpp"
+
+#if RTIMERS_HAVE_CXX11
+#  include "rtimers/selector.hpp"
+#endif
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+#if RTIMERS_HAVE_CXX11
+
+namespace {
+
+unsigned simpleCalls = 0, blockedCalls = 0;
+
+//! Simulated implementation, with fixed overhead and fast per-item cost
+int simple(size_t n, int x) {
+  ++simpleCalls;
+  ManualClock::advance(1e-6 + n * 1e-9);
+  return x + 1;
+}
+
+//! Simulated implementation, with no overhead but slower per-item cost
+int blocked(size_t n, int x) {
+  ++blockedCalls;
+  ManualClock::advance(n * 4e-9);
+  return x + 1;
+}
+
+typedef Selector<int(size_t, int), ManualClock> SimSelector;
+
+
+void checkChoices(SimSelector& sel, unsigned maxMisses)
+{
+  sel.add("simple", simple);
+  sel.add("blocked", blocked);
+
+  // Cost-crossover occurs at n = 1e-6 / 3e-9 ~= 333:
+  const size_t sizes[] = { 16, 4096 };
+  for (unsigned s=0; s<2; ++s) {
+    simpleCalls = blockedCalls = 0;
+
+    for (int i=0; i<5000; ++i) {
+      BOOST_CHECK_EQUAL(sel(sizes[s], sizes[s], i), i + 1);
+    }
+
+    const unsigned misses = (s == 0 ? simpleCalls : blockedCalls);
+    BOOST_CHECK_EQUAL(simpleCalls + blockedCalls, 5000);
+    BOOST_CHECK_GE(misses, 8);
+    BOOST_CHECK_LE(misses, maxMisses);
+  }
+
+  BOOST_CHECK_EQUAL(sel.choice(16), 1);
+  BOOST_CHECK_EQUAL(sel.choice(31), 1);
+  BOOST_CHECK_EQUAL(sel.choice(4096), 0);
+  BOOST_CHECK_EQUAL(sel.getName(sel.choice(4096)), "simple");
+  BOOST_CHECK_GE(sel.getStats(16, 0).count, 8);
+  BOOST_CHECK_EQUAL(sel.getStats(1000, 0).count, 0);
+}
+
+}   // namespace (anonymous)
+
+#endif  // RTIMERS_HAVE_CXX11
+
+
+TestSelector::TestSelector()
+  : BoostUT::test_suite("implementation selection")
+{
+  add(BOOST_TEST_CASE(classes));
+  add(BOOST_TEST_CASE(greedy));
+  add(BOOST_TEST_CASE(confidence));
+  add(BOOST_TEST_CASE(adding));
+}
+
+
+void TestSelector::classes()
+{
+#if RTIMERS_HAVE_CXX11
+  BOOST_CHECK_EQUAL(SimSelector::sizeClass(0), 0);
+  BOOST_CHECK_EQUAL(SimSelector::sizeClass(1), 0);
+  BOOST_CHECK_EQUAL(SimSelector::sizeClass(2), 1);
+  BOOST_CHECK_EQUAL(SimSelector::sizeClass(3), 1);
+  BOOST_CHECK_EQUAL(SimSelector::sizeClass(4096), 12);
+  BOOST_CHECK_EQUAL(SimSelector::sizeClass(~size_t(0)),
+                    SimSelector::NCLASSES - 1);
+#endif
+}
+
+
+void TestSelector::greedy()
+{
+#if RTIMERS_HAVE_CXX11
+  SimSelector sel(SimSelector::EPSILON_GREEDY);
+  checkChoices(sel, 40);
+#endif
+}
+
+
+void TestSelector::confidence()
+{
+#if RTIMERS_HAVE_CXX11
+  SimSelector sel(SimSelector::UCB);
+  checkChoices(sel, 40);
+
+  CollectingLogger::rows.clear();
+  sel.report<CollectingLogger>("copy");
+  BOOST_REQUIRE_EQUAL(CollectingLogger::rows.size(), 4);
+  BOOST_CHECK_EQUAL(CollectingLogger::ident(0), "copy[16]/simple");
+  BOOST_CHECK_EQUAL(CollectingLogger::ident(1), "copy[16]/blocked*");
+  BOOST_CHECK_EQUAL(CollectingLogger::ident(2), "copy[4096]/simple*");
+  BOOST_CHECK_EQUAL(CollectingLogger::ident(3), "copy[4096]/blocked");
+#endif
+}
+
+
+void TestSelector::adding()
+{
+#if RTIMERS_HAVE_CXX11
+  SimSelector sel(SimSelector::UCB);
+  BOOST_CHECK_THROW(sel(16, 16, 0), std::logic_error);
+  BOOST_CHECK(!sel.add("null", nullptr));
+
+  // A candidate added after timing has started should still be explored:
+  BOOST_REQUIRE(sel.add("blocked", blocked));
+  for (int i=0; i<500; ++i) sel(4096, 4096, i);
+  BOOST_REQUIRE(sel.add("simple", simple));
+  BOOST_CHECK_EQUAL(sel.getStats(4096, 1).count, 0);
+
+  simpleCalls = 0;
+  for (int i=0; i<2000; ++i) {
+    BOOST_CHECK_EQUAL(sel(4096, 4096, i), i + 1);
+  }
+  BOOST_CHECK_EQUAL(sel.choice(4096), 1);
+  BOOST_CHECK_GE(sel.getStats(4096, 1).count, 8);
+  BOOST_CHECK(std::isfinite(sel.getStats(4096, 1).logMean));
+  BOOST_CHECK_GT(simpleCalls, 1900);
+#endif
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers
@@ -0,0 +1,127 @@
+/*
+ *  Unit-tests for process-wide stall detection
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <sstream>
+
+#include "testdefns.hpp"
+#include "rtimers/stall.hpp"
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+
+TestStall::TestStall()
+  : BoostUT::test_suite("process-wide stall detection")
+{
+  add(BOOST_TEST_CASE(heartbeat));
+  add(BOOST_TEST_CASE(flagging));
+  add(BOOST_TEST_CASE(tracing));
+}
+
+
+void TestStall::heartbeat()
+{
+  StallDetector detector;
+
+  detector.start(1e-3, 0.5);
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  BOOST_CHECK(detector.isRunning());
+  detector.stop();
+  BOOST_CHECK(!detector.isRunning());
+
+  const VarBoundStats lateness = detector.getLateness();
+  BOOST_CHECK_GT(lateness.count, 5);
+  BOOST_CHECK_GE(lateness.tmin, 0.0);
+  BOOST_CHECK_LT(lateness.mean, 0.1);
+
+  const StallDetector::Instant now = StallDetector::Clock::now();
+  detector.noteWakeup(now - std::chrono::milliseconds(600), now);
+  BOOST_CHECK_EQUAL(detector.getStallCount(), 1);
+  BOOST_CHECK(detector.hasCovered(now));
+  BOOST_CHECK(detector.overlapsStall(now - std::chrono::milliseconds(10),
+                                     now + std::chrono::milliseconds(10)));
+  BOOST_CHECK(!detector.overlapsStall(now - std::chrono::seconds(5),
+                                      now - std::chrono::seconds(4)));
+}
+
+
+void TestStall::flagging()
+{
+  typedef StallDetector::Clock Clock;
+  StallDetector& detector = StallDetector::global();
+  StallFlaggedStats<VarBoundStats> stats;
+
+  for (unsigned i=0; i<50; ++i) {
+    stats.addSample(1e-3);
+  }
+  BOOST_CHECK_EQUAL(stats.outliers, 0);
+
+  // Outlier long after the most recent stall:
+  const Clock::time_point past = Clock::now() - std::chrono::seconds(10);
+  detector.noteWakeup(past - std::chrono::milliseconds(50), past);
+  stats.addSample(40e-3);
+
+  // Punctual heartbeat, allowing the first outlier to be resolved:
+  const Clock::time_point beat = Clock::now();
+  detector.noteWakeup(beat, beat);
+  stats.addSample(1e-3);
+
+  // Outlier coinciding with a fresh stall:
+  const Clock::time_point recent = Clock::now();
+  detector.noteWakeup(recent - std::chrono::milliseconds(50), recent);
+  stats.addSample(40e-3);
+
+  stats.addSample(1.1e-3);
+  BOOST_CHECK_EQUAL(stats.count, 54);
+  BOOST_CHECK_EQUAL(stats.outliers, 2);
+  BOOST_CHECK_EQUAL(stats.countStalled(), 1);
+
+  std::stringstream report;
+  report << stats;
+  BOOST_CHECK(report.str().find("outliers = 2 (1 during stalls)")
+                != std::string::npos);
+}
+
+
+void TestStall::tracing()
+{
+#if RTIMERS_HAVE_POSIX
+  typedef StallDetector::Clock Clock;
+  ftrace::TraceMarker& marker = ftrace::TraceMarker::global();
+  TempDir dir("stall");
+  BOOST_REQUIRE(!dir.path.empty());
+  const std::string markerPath = dir.path + "/trace_marker";
+  std::ofstream(markerPath.c_str());
+  std::ostringstream pid;
+  pid << getpid();
+
+  StallDetector detector;
+  BOOST_REQUIRE(marker.open(markerPath, ""));
+  const Clock::time_point now = Clock::now();
+  detector.noteWakeup(now, now + std::chrono::microseconds(500));
+  detector.noteWakeup(now, now + std::chrono::milliseconds(25));
+  marker.close();
+
+  std::ifstream strm(markerPath.c_str());
+  std::stringstream trace;
+  trace << strm.rdbuf();
+  const std::string prefix = "C|" + pid.str() + "|rtimers.stall_us|";
+  BOOST_CHECK_EQUAL(trace.str(), prefix + "25000" + prefix + "0");
+#endif  // RTIMERS_HAVE_POSIX
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers
@@ -0,0 +1,102 @@
+/*
+ *  Unit-tests for the process start-up timeline
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+
+#include "testdefns.hpp"
+
+#if RTIMERS_HAVE_POSIX
+#  include "rtimers/startup.hpp"
+#endif
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+TestStartup::TestStartup()
+  : BoostUT::test_suite("process start-up timeline")
+{
+  add(BOOST_TEST_CASE(milestones));
+}
+
+
+void TestStartup::milestones()
+{
+#if RTIMERS_HAVE_POSIX
+  StartupProfiler& profiler = StartupProfiler::global();
+
+  BOOST_CHECK_GT(StartupProfiler::processStartTime(), 0.0);
+  BOOST_CHECK_GT(profiler.sinceExec(), 0.0);
+  BOOST_CHECK_LT(profiler.sinceExec(), 3600.0);
+
+  profiler.mark("tests running");
+  BOOST_CHECK(profiler.loadLibrary("libc.so.6") != NULL);
+  profiler.mark("plugins");
+  CollectingLogger::rows.clear();
+  BOOST_CHECK(profiler.markReady<CollectingLogger>());
+  BOOST_CHECK(!profiler.markReady<CollectingLogger>("ready again"));
+
+  const std::vector<StartupProfiler::Milestone> milestones =
+                                                    profiler.getMilestones();
+  BOOST_REQUIRE_GE(milestones.size(), 5);
+  BOOST_CHECK_EQUAL(milestones.front().name, "static-init");
+  BOOST_CHECK_EQUAL(milestones.back().name, "ready again");
+  BOOST_CHECK_GE(milestones.front().time, 0.0);
+  BOOST_CHECK_GT(milestones.front().libraries.size(), 2);
+  BOOST_CHECK_GT(milestones.front().librarySize, 0);
+  BOOST_CHECK_EQUAL(milestones.front().loadTime, 0.0);
+
+  const size_t pl = milestones.size() - 3;
+  BOOST_CHECK_EQUAL(milestones[pl].name, "plugins");
+  BOOST_CHECK_GT(milestones[pl].loadTime, 0.0);
+  BOOST_CHECK_EQUAL(milestones.back().loadTime, 0.0);
+
+  for (size_t i=1; i<milestones.size(); ++i) {
+    BOOST_CHECK_GE(milestones[i].time, milestones[i-1].time);
+  }
+
+  BOOST_REQUIRE(!CollectingLogger::rows.empty());
+  const std::string& report = CollectingLogger::rows.back();
+  BOOST_CHECK(report.find("startup: exec -> static-init +") == 0);
+  BOOST_CHECK(report.find("-> tests running +") != std::string::npos);
+  BOOST_CHECK(report.find("-> ready +") != std::string::npos);
+  BOOST_CHECK(report.find("ready again") == std::string::npos);
+  BOOST_CHECK(report.find("-> plugins +") != std::string::npos);
+
+  Registry& registry = Registry::global();
+  BOOST_CHECK_EQUAL(registry.lookup("startup.static-init").read().count, 1);
+  BOOST_CHECK_EQUAL(registry.lookup("startup.plugins").read().count, 1);
+  BOOST_CHECK_EQUAL(registry.lookup("startup.ready again").read().count, 1);
+  BOOST_CHECK_GE(registry.lookup("startup.dlopen").read().count, 1);
+  BOOST_CHECK_CLOSE(registry.lookup("startup.plugins").read().getMean(),
+                    milestones[pl].time - milestones[pl-1].time, 1e-6);
+
+  // Marking "ready" directly should also report, but only once:
+  Registry local;
+  StartupProfiler second(local);
+  CollectingLogger::rows.clear();
+  second.mark<CollectingLogger>("main");
+  BOOST_CHECK(CollectingLogger::rows.empty());
+  second.mark<CollectingLogger>("ready");
+  second.mark<CollectingLogger>("ready");
+  BOOST_REQUIRE_EQUAL(CollectingLogger::rows.size(), 1);
+  BOOST_CHECK(CollectingLogger::rows[0].find("-> main +") != std::string::npos);
+  BOOST_CHECK_EQUAL(local.lookup("startup.ready").read().count, 2);
+#else
+  BOOST_ERROR("No /proc support");
+#endif  // RTIMERS_HAVE_POSIX
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers
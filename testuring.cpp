@@ -0,0 +1,195 @@
+/*
+ *  Unit-tests for io_uring latency instrumentation
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "testdefns.hpp"
+
+#if defined(__linux)
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include "rtimers/cxx11.hpp"
+#  include "rtimers/uring.hpp"
+#endif
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+#if defined(__linux)
+
+namespace {
+
+typedef TimedUring<cxx11::HiResClock> Ring;
+
+}   // namespace
+
+#endif  // __linux
+
+
+TestUring::TestUring()
+  : BoostUT::test_suite("io_uring latency")
+{
+  add(BOOST_TEST_CASE(fileIO));
+  add(BOOST_TEST_CASE(queueFull));
+  add(BOOST_TEST_CASE(externalRing));
+}
+
+
+void TestUring::fileIO()
+{
+#if defined(__linux)
+  Ring ring(16);
+  if (!ring.isReady()) {
+    BOOST_TEST_MESSAGE("io_uring unavailable - skipping");
+    return;
+  }
+
+  char path[] = "/tmp/rtimers-uring-XXXXXX";
+  const int fd = mkstemp(path);
+  BOOST_REQUIRE_GE(fd, 0);
+  unlink(path);
+
+  const unsigned nBlocks = 4, blockSize = 4096;
+  std::vector<char> out(nBlocks * blockSize), in(nBlocks * blockSize, 0);
+  for (size_t i=0; i<out.size(); ++i) out[i] = char('a' + i % 23);
+
+  for (unsigned b=0; b<nBlocks; ++b) {
+    BOOST_REQUIRE(ring.write(fd, &out[b * blockSize], blockSize,
+                             b * blockSize, 100 + b));
+  }
+  BOOST_CHECK_EQUAL(ring.submit(), int(nBlocks));
+  BOOST_CHECK_EQUAL(ring.inFlight(), nBlocks);
+
+  UringCompletion done;
+  unsigned long tagSum = 0;
+  while (ring.inFlight() > 0 && ring.wait(done)) {
+    BOOST_CHECK_EQUAL(done.opcode, IORING_OP_WRITE);
+    BOOST_CHECK_EQUAL(done.result, int(blockSize));
+    BOOST_CHECK_GE(done.latency, 0.0);
+    tagSum += done.tag;
+  }
+  BOOST_CHECK_EQUAL(tagSum, 100 * nBlocks + 6);
+  BOOST_CHECK(!ring.poll(done));
+
+  BOOST_REQUIRE(ring.fsync(fd, 7));
+  BOOST_REQUIRE_EQUAL(ring.submit(), 1);
+  BOOST_REQUIRE(ring.wait(done));
+  BOOST_CHECK_EQUAL(done.tag, 7);
+  BOOST_CHECK_EQUAL(done.opcode, IORING_OP_FSYNC);
+  BOOST_CHECK_EQUAL(done.result, 0);
+
+  for (unsigned b=0; b<nBlocks; ++b) {
+    BOOST_REQUIRE(ring.read(fd, &in[b * blockSize], blockSize,
+                            b * blockSize));
+  }
+  BOOST_CHECK_EQUAL(ring.submit(), int(nBlocks));
+  for (unsigned b=0; b<nBlocks; ++b) {
+    BOOST_REQUIRE(ring.wait(done));
+    BOOST_CHECK_EQUAL(done.result, int(blockSize));
+  }
+  BOOST_CHECK(in == out);
+  close(fd);
+
+  BOOST_REQUIRE_EQUAL(ring.getStats().size(), 3);
+  BOOST_CHECK_EQUAL(ring.getStats().at(IORING_OP_WRITE).count, nBlocks);
+  BOOST_CHECK_EQUAL(ring.getStats().at(IORING_OP_FSYNC).count, 1);
+  BOOST_CHECK_EQUAL(ring.getStats().at(IORING_OP_READ).count, nBlocks);
+  BOOST_CHECK_EQUAL(ring.getDepth().count, 2 * nBlocks + 1);
+  BOOST_CHECK_EQUAL(ring.getDepth().tmax, nBlocks);
+  BOOST_CHECK_EQUAL(ring.getDepth().tmin, 1);
+
+  CollectingLogger::rows.clear();
+  ring.report<CollectingLogger>("store");
+  BOOST_REQUIRE_EQUAL(CollectingLogger::rows.size(), 4);
+  BOOST_CHECK_EQUAL(CollectingLogger::ident(0), "store.fsync");
+  BOOST_CHECK_EQUAL(CollectingLogger::ident(1), "store.read");
+  BOOST_CHECK_EQUAL(CollectingLogger::ident(2), "store.write");
+  BOOST_CHECK_EQUAL(CollectingLogger::ident(3), "store.depth");
+  BOOST_CHECK(CollectingLogger::rows[3].find("<t> = ") != std::string::npos);
+#endif
+}
+
+
+void TestUring::queueFull()
+{
+#if defined(__linux)
+  Ring ring(4);
+  if (!ring.isReady()) return;
+
+  unsigned prepared = 0;
+  while (ring.prepare(IORING_OP_NOP, prepared)) ++prepared;
+  BOOST_CHECK_EQUAL(prepared, 4);
+  BOOST_CHECK_EQUAL(ring.submit(), 4);
+  BOOST_CHECK(ring.prepare(IORING_OP_NOP, 99) != NULL);
+  BOOST_CHECK_EQUAL(ring.submit(), 1);
+
+  UringCompletion done;
+  unsigned collected = 0;
+  while (ring.wait(done)) {
+    BOOST_CHECK_EQUAL(done.opcode, IORING_OP_NOP);
+    ++collected;
+  }
+  BOOST_CHECK_EQUAL(collected, 5);
+  BOOST_CHECK_EQUAL(ring.getStats().at(IORING_OP_NOP).count, 5);
+  BOOST_CHECK_EQUAL(Ring::opName(IORING_OP_NOP), "nop");
+  BOOST_CHECK_EQUAL(Ring::opName(200), "op200");
+#endif
+}
+
+
+void TestUring::externalRing()
+{
+#if defined(__linux)
+  // Entries prepared by another library only need stamping and completing:
+  UringTimer<cxx11::HiResClock> timing;
+  io_uring_sqe sqes[2];
+  std::memset(sqes, 0, sizeof(sqes));
+  sqes[0].opcode = IORING_OP_READ;
+  sqes[0].user_data = 1001;
+  sqes[1].opcode = IORING_OP_FSYNC;
+  sqes[1].user_data = 1002;
+
+  timing.stamp(&sqes[0]);
+  timing.stamp(&sqes[1]);
+  BOOST_CHECK_NE(sqes[0].user_data, sqes[1].user_data);
+  BOOST_CHECK_EQUAL(timing.inFlight(), 2);
+
+  io_uring_cqe cqe;
+  std::memset(&cqe, 0, sizeof(cqe));
+  cqe.user_data = sqes[1].user_data;
+  UringCompletion done;
+  BOOST_REQUIRE(timing.complete(&cqe, done));
+  BOOST_CHECK_EQUAL(done.tag, 1002);
+  BOOST_CHECK_EQUAL(done.opcode, IORING_OP_FSYNC);
+  BOOST_CHECK_GE(done.latency, 0.0);
+
+  cqe.user_data = sqes[0].user_data;
+  cqe.res = 512;
+  BOOST_REQUIRE(timing.complete(&cqe, done));
+  BOOST_CHECK_EQUAL(done.tag, 1001);
+  BOOST_CHECK_EQUAL(done.result, 512);
+  BOOST_CHECK_EQUAL(timing.inFlight(), 0);
+
+  cqe.user_data = 77;
+  BOOST_CHECK(!timing.complete(&cqe, done));
+  BOOST_CHECK_EQUAL(timing.getStats().size(), 2);
+  BOOST_CHECK_EQUAL(timing.getDepth().tmax, 2);
+#endif
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers
@@ -0,0 +1,141 @@
+/*
+ *  Unit-tests for USDT probes within timers
+ */
+
+//  (C)Copyright 2026, RW Penney
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <boost/test/unit_test.hpp>
+#include <cstdio>
+#include <string>
+
+#include "testdefns.hpp"
+
+#if RTIMERS_HAVE_USDT
+#  include <unistd.h>
+#endif
+
+namespace BoostUT = boost::unit_test;
+
+
+namespace rtimers {
+  namespace testing {
+
+//! Manager written before updateStats() could return the interval
+struct VoidManager : public SerialManager<ManualClock, BoundStats>
+{
+  void updateStats(const Instant& now, BoundStats& stats) {
+    stats.addSample(now - startTime);
+  }
+};
+
+#if RTIMERS_HAVE_USDT
+
+typedef Timer<SerialManager<C89clock, BoundStats>, NullLogger> QuietTimer;
+
+//! Capture the output of "readelf -n" applied to the running executable
+static std::string readNotes()
+{
+  char exe[1024];
+  const ssize_t len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+  if (len <= 0) return std::string();
+  exe[len] = '\0';
+
+  const std::string cmd = std::string("readelf -n '") + exe + "' 2>/dev/null";
+  FILE* pipe = popen(cmd.c_str(), "r");
+  if (!pipe) return std::string();
+
+  std::string notes;
+  char buff[256];
+  while (fgets(buff, sizeof(buff), pipe)) {
+    notes += buff;
+  }
+  pclose(pipe);
+
+  return notes;
+}
+
+#endif  // RTIMERS_HAVE_USDT
+
+
+TestUsdt::TestUsdt()
+  : BoostUT::test_suite("USDT probe points")
+{
+  add(BOOST_TEST_CASE(notes));
+  add(BOOST_TEST_CASE(semaphores));
+  add(BOOST_TEST_CASE(legacy));
+}
+
+
+void TestUsdt::notes()
+{
+#if RTIMERS_HAVE_USDT
+  { QuietTimer tmr("usdt");
+    tmr.start();
+    tmr.stop();
+  }
+
+  const std::string notes = readNotes();
+  BOOST_REQUIRE(!notes.empty());
+
+  BOOST_CHECK(notes.find(".note.stapsdt") != std::string::npos);
+  BOOST_CHECK(notes.find("Provider: rtimers") != std::string::npos);
+  BOOST_CHECK(notes.find("Name: timer_start") != std::string::npos);
+  BOOST_CHECK(notes.find("Name: timer_stop") != std::string::npos);
+  BOOST_CHECK(notes.find("-8@%") != std::string::npos
+              || notes.find("-8@x") != std::string::npos);
+#else
+  BOOST_TEST_MESSAGE("USDT probes not enabled");
+#endif  // RTIMERS_HAVE_USDT
+}
+
+
+void TestUsdt::semaphores()
+{
+#if RTIMERS_HAVE_USDT
+  QuietTimer tmr("attached");
+  const unsigned count = 100;
+
+  // Simulate an attached tracer, so that probe arguments are prepared:
+  ++rtimers_timer_start_semaphore;
+  ++rtimers_timer_stop_semaphore;
+
+  for (unsigned i=0; i<count; ++i) {
+    QuietTimer::Scoper sc = tmr.scopedStart();
+  }
+
+  --rtimers_timer_start_semaphore;
+  --rtimers_timer_stop_semaphore;
+
+  BOOST_CHECK_EQUAL(tmr.getStats().count, count);
+  BOOST_CHECK_EQUAL(rtimers_timer_stop_semaphore, 0);
+#else
+  BOOST_TEST_MESSAGE("USDT probes not enabled");
+#endif  // RTIMERS_HAVE_USDT
+}
+
+
+void TestUsdt::legacy()
+{
+  Timer<VoidManager, NullLogger> tmr("legacy");
+
+#if RTIMERS_HAVE_USDT
+  ++rtimers_timer_stop_semaphore;
+#endif
+  tmr.start();
+  ManualClock::advance(0.5);
+  tmr.stop();
+#if RTIMERS_HAVE_USDT
+  --rtimers_timer_stop_semaphore;
+#endif
+
+  BOOST_CHECK_EQUAL(tmr.getStats().count, 1);
+  BOOST_CHECK_CLOSE(tmr.getStats().tmax, 0.5, 1e-6);
+}
+
+
+  }   // namespace testing
+}   // namespace rtimers